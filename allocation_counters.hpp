@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+
+// Build with `-DPROFILE_ALLOCATIONS=1` to replace global `operator new`/`delete` with counting ones.
+#ifndef PROFILE_ALLOCATIONS
+#define PROFILE_ALLOCATIONS 0
+#endif
+
+
+// Number and total size of heap allocations made through global `operator new` since program start
+// (of all threads). Counting is compiled in only with `PROFILE_ALLOCATIONS`, otherwise values stay zero.
+
+class allocation_counters_t
+{
+public:
+    static const bool ENABLED = (PROFILE_ALLOCATIONS != 0);
+
+    struct values_t
+    {
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+    };
+
+
+public:
+    static values_t read_values()
+    {
+        return values_t { allocations.load(std::memory_order_relaxed), bytes.load(std::memory_order_relaxed) };
+    }
+
+    static void record(std::size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+
+private:
+    static std::atomic<std::uint64_t> allocations;
+    static std::atomic<std::uint64_t> bytes;
+};
+
+std::atomic<std::uint64_t> allocation_counters_t::allocations(0);
+std::atomic<std::uint64_t> allocation_counters_t::bytes(0);
+
+
+#if PROFILE_ALLOCATIONS
+// Replaced `operator new` allocates with `malloc`, so freeing with `free` is correct (GCC can't tell once inlined)
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+    allocation_counters_t::record(size);
+
+    void* result = std::malloc((size > 0) ? size : 1);
+    if (result == nullptr)
+        throw std::bad_alloc();
+
+    return result;
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    allocation_counters_t::record(size);
+    return std::malloc((size > 0) ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+#endif
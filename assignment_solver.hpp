@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "types.hpp"
+
+
+// Assignment of busters (rows) to tasks (columns) minimizing total score of chosen (buster, task) pairs.
+//
+// Shared columns (bust, cover, return) can be chosen by any number of rows, exclusive columns (explore, stun)
+// by at most one row, and chosen exclusive columns must not conflict with each other (e.g. explore locations
+// too close to each other).
+//
+// Problem is solved by Hungarian algorithm over exclusive columns plus one private column per row standing
+// for row's best shared column. Conflicts are added lazily: while optimal assignment contains conflicting pair,
+// the more expensive of the two picks is forbidden and problem is solved again. Solving stops at given deadline
+// and greedy selection (pairs taken in increasing score order, skipping disallowed ones) is kept as fallback,
+// so the result is never worse than greedy one.
+
+class assignment_solver_t
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    static const std::size_t UNASSIGNED = std::numeric_limits<std::size_t>::max();
+
+
+public:
+    assignment_solver_t()
+        : rows_count(0), columns_count(0), optimal(false)
+    {
+    }
+
+    // Prepares problem of given size, all scores have to be set before solving
+    void reset(std::size_t rows, std::size_t columns)
+    {
+        rows_count = rows;
+        columns_count = columns;
+
+        scores.resize(rows * columns);
+        exclusive.assign(columns, false);
+        choices.assign(rows, UNASSIGNED);
+        optimal = false;
+    }
+
+    factor_t& score(std::size_t row, std::size_t column)
+    {
+        return scores[row * columns_count + column];
+    }
+
+    void set_exclusive(std::size_t column)
+    {
+        exclusive[column] = true;
+    }
+
+    // Orders all pairs by score for greedy selection, has to be called after scores are set and before `solve`
+    void sort_candidates()
+    {
+        order.resize(scores.size());
+        std::iota(std::begin(order), std::end(order), 0);
+        std::sort(std::begin(order), std::end(order), [this](std::uint32_t a, std::uint32_t b) {
+            return (scores[a] < scores[b]) || (scores[a] == scores[b] && a < b);
+        });
+    }
+
+    // `conflicts(a, b)` tells whether two different exclusive columns can't be chosen together
+    template <typename conflicts_type>
+    void solve(conflicts_type conflicts, clock_t::time_point deadline)
+    {
+        solve_greedy(conflicts);
+
+        if (rows_count == 0 || clock_t::now() >= deadline)
+            return;
+
+        prepare_optimal();
+
+        while (clock_t::now() < deadline)
+        {
+            solve_hungarian();
+
+            if (resolve_conflicts(conflicts))
+                continue;
+
+            if (is_better(optimal_choices, choices))
+            {
+                choices = optimal_choices;
+                optimal = true;
+            }
+
+            break;
+        }
+    }
+
+    // Column chosen for given row or `UNASSIGNED`
+    std::size_t get_choice(std::size_t row) const
+    {
+        return choices[row];
+    }
+
+    // Whether choices come from optimal solver (otherwise from greedy fallback)
+    bool is_optimal() const
+    {
+        return optimal;
+    }
+
+
+private:
+    template <typename conflicts_type>
+    bool is_allowed(std::size_t column, conflicts_type conflicts) const
+    {
+        if (!exclusive[column])
+            return true;
+
+        for (std::size_t taken_column : taken_columns)
+        {
+            if (taken_column == column || conflicts(taken_column, column))
+                return false;
+        }
+
+        return true;
+    }
+
+    template <typename conflicts_type>
+    void solve_greedy(conflicts_type conflicts)
+    {
+        taken_columns.clear();
+        std::size_t assigned_count = 0;
+        for (std::uint32_t cell : order)
+        {
+            if (assigned_count == rows_count)
+                break;
+
+            std::size_t row = cell / columns_count;
+            std::size_t column = cell % columns_count;
+
+            if (choices[row] != UNASSIGNED || !is_allowed(column, conflicts))
+                continue;
+
+            choices[row] = column;
+            ++assigned_count;
+
+            if (exclusive[column])
+                taken_columns.push_back(column);
+        }
+    }
+
+    void prepare_optimal()
+    {
+        forbidden.assign(scores.size(), false);
+
+        exclusive_columns.clear();
+        for (std::size_t column = 0; column < columns_count; ++column)
+        {
+            if (exclusive[column])
+                exclusive_columns.push_back(column);
+        }
+
+        best_shared_columns.assign(rows_count, UNASSIGNED);
+        for (std::size_t row = 0; row < rows_count; ++row)
+        {
+            for (std::size_t column = 0; column < columns_count; ++column)
+            {
+                std::size_t& best = best_shared_columns[row];
+                if (!exclusive[column] && (best == UNASSIGNED || score(row, column) < score(row, best)))
+                    best = column;
+            }
+        }
+    }
+
+    // Cost of choosing i-th Hungarian column (exclusive columns followed by private ones) for given row
+    factor_t get_cost(std::size_t row, std::size_t i) const
+    {
+        std::size_t column;
+
+        if (i < exclusive_columns.size())
+            column = exclusive_columns[i];
+        else if (i - exclusive_columns.size() == row)
+            column = best_shared_columns[row];
+        else
+            return FORBIDDEN_COST;
+
+        if (column == UNASSIGNED || forbidden[row * columns_count + column])
+            return FORBIDDEN_COST;
+
+        return std::min(scores[row * columns_count + column], FORBIDDEN_COST);
+    }
+
+    // Rectangular Hungarian algorithm (rows <= columns) with potentials, O(rows^2 * columns)
+    void solve_hungarian()
+    {
+        const std::size_t n = rows_count;
+        const std::size_t m = exclusive_columns.size() + rows_count;
+        const factor_t INF = std::numeric_limits<factor_t>::max();
+
+        u.assign(n + 1, 0.0);
+        v.assign(m + 1, 0.0);
+        matched_rows.assign(m + 1, 0);
+        way.assign(m + 1, 0);
+
+        for (std::size_t i = 1; i <= n; ++i)
+        {
+            matched_rows[0] = i;
+            std::size_t j0 = 0;
+            min_values.assign(m + 1, INF);
+            used.assign(m + 1, false);
+
+            do
+            {
+                used[j0] = true;
+                std::size_t i0 = matched_rows[j0];
+                factor_t delta = INF;
+                std::size_t j1 = 0;
+
+                for (std::size_t j = 1; j <= m; ++j)
+                {
+                    if (used[j])
+                        continue;
+
+                    factor_t current = get_cost(i0 - 1, j - 1) - u[i0] - v[j];
+                    if (current < min_values[j])
+                    {
+                        min_values[j] = current;
+                        way[j] = j0;
+                    }
+
+                    if (min_values[j] < delta)
+                    {
+                        delta = min_values[j];
+                        j1 = j;
+                    }
+                }
+
+                for (std::size_t j = 0; j <= m; ++j)
+                {
+                    if (used[j])
+                    {
+                        u[matched_rows[j]] += delta;
+                        v[j] -= delta;
+                    }
+                    else
+                    {
+                        min_values[j] -= delta;
+                    }
+                }
+
+                j0 = j1;
+            }
+            while (matched_rows[j0] != 0);
+
+            do
+            {
+                std::size_t j1 = way[j0];
+                matched_rows[j0] = matched_rows[j1];
+                j0 = j1;
+            }
+            while (j0 != 0);
+        }
+
+        optimal_choices.assign(rows_count, UNASSIGNED);
+        for (std::size_t j = 1; j <= m; ++j)
+        {
+            if (matched_rows[j] == 0)
+                continue;
+
+            std::size_t row = matched_rows[j] - 1;
+            if (get_cost(row, j - 1) >= FORBIDDEN_COST)
+                continue;
+
+            optimal_choices[row] = (j - 1 < exclusive_columns.size()) ? exclusive_columns[j - 1] : best_shared_columns[row];
+        }
+    }
+
+    // Forbids the more expensive pick of the first conflicting pair, returns whether any conflict was found
+    template <typename conflicts_type>
+    bool resolve_conflicts(conflicts_type conflicts)
+    {
+        for (std::size_t a = 0; a < rows_count; ++a)
+        {
+            std::size_t column_a = optimal_choices[a];
+            if (column_a == UNASSIGNED || !exclusive[column_a])
+                continue;
+
+            for (std::size_t b = a + 1; b < rows_count; ++b)
+            {
+                std::size_t column_b = optimal_choices[b];
+                if (column_b == UNASSIGNED || !exclusive[column_b] || !conflicts(column_a, column_b))
+                    continue;
+
+                if (score(a, column_a) > score(b, column_b))
+                    forbidden[a * columns_count + column_a] = true;
+                else
+                    forbidden[b * columns_count + column_b] = true;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // More assigned rows first, then lower total score
+    bool is_better(const std::vector<std::size_t>& first, const std::vector<std::size_t>& second) const
+    {
+        std::size_t first_count = 0, second_count = 0;
+        factor_t first_total = 0.0, second_total = 0.0;
+
+        for (std::size_t row = 0; row < rows_count; ++row)
+        {
+            if (first[row] != UNASSIGNED)
+            {
+                ++first_count;
+                first_total += scores[row * columns_count + first[row]];
+            }
+
+            if (second[row] != UNASSIGNED)
+            {
+                ++second_count;
+                second_total += scores[row * columns_count + second[row]];
+            }
+        }
+
+        return (first_count > second_count) || (first_count == second_count && first_total < second_total);
+    }
+
+
+private:
+    static constexpr factor_t FORBIDDEN_COST = 1e12; // well above any score, keeps potentials finite
+
+    std::size_t rows_count;
+    std::size_t columns_count;
+    std::vector<factor_t> scores; // row-major
+    std::vector<bool> exclusive; // per column
+    std::vector<std::size_t> choices; // per row
+    bool optimal;
+
+    // Scratch buffers, kept to avoid allocations every round
+    std::vector<std::uint32_t> order;
+    std::vector<std::size_t> taken_columns;
+    std::vector<bool> forbidden; // per cell, picks excluded by resolved conflicts
+    std::vector<std::size_t> exclusive_columns;
+    std::vector<std::size_t> best_shared_columns; // per row
+    std::vector<std::size_t> optimal_choices;
+    std::vector<factor_t> u;
+    std::vector<factor_t> v;
+    std::vector<std::size_t> matched_rows;
+    std::vector<std::size_t> way;
+    std::vector<factor_t> min_values;
+    std::vector<bool> used;
+};
+
+const std::size_t assignment_solver_t::UNASSIGNED;
+constexpr factor_t assignment_solver_t::FORBIDDEN_COST;
@@ -0,0 +1,471 @@
+// Allocations per operation are counted unless built with `-DPROFILE_ALLOCATIONS=0` (counting adds a few
+// nanoseconds to every allocation and to every phase measured inside the stages)
+#ifndef PROFILE_ALLOCATIONS
+#define PROFILE_ALLOCATIONS 1
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "allocation_counters.hpp"
+#include "codebusters_player.hpp"
+#include "command_line.hpp"
+
+
+// Usage: benchmark [--busters 2,3,4,5] [--ghosts 0,5,15,30] [--tasks 10,100,500,2000]
+//                  [--iterations N] [--repeats N] [--seed N] [--filter NAME]
+//
+// Micro-benchmarks of single stages of bot's round on synthetic states: `input::read_round_data`,
+// `compute_tracking_data`, `on_new_round`, `assign_tasks` and `execute_assignments`, swept over number of busters
+// per player, visible ghosts and number of EXPLORE tasks inserted before measuring (late-game accumulation).
+//
+// Every state is generated from `--seed` and sweep values only: bot plays one round from it, then tasks are inserted
+// and next round (busters moved, half of ghosts replaced, half of enemies gone) is read. Each stage then runs
+// `--iterations` times on that state (`assign_tasks` with score cache invalidated, as if busters moved) after one
+// untimed warm-up run, best of `--repeats` batches is reported. Bot's state which stages change (tracked data, tasks,
+// assignments, commands, random engine) is restored before every run, outside of measured time and allocations,
+// so that every run sees the stated state rather than the one left by previous runs. Time of reading the clock
+// around every run is subtracted. Tasks pool is bounded, `resident` is number of tasks it actually holds.
+//
+// Output has one line per stage and state with fixed columns, so that runs before and after a change can be
+// diffed; only `ns/op` and `ops/s` depend on the machine.
+
+namespace
+{
+    struct measurement_t
+    {
+        double nanoseconds;
+        double allocations;
+        double bytes;
+        std::size_t resident_tasks;
+    };
+
+    // Mean time of reading the clock twice, as around every measured run (best of a few batches)
+    double get_clock_overhead()
+    {
+        using clock_t = std::chrono::steady_clock;
+        const std::size_t SAMPLES = 10000;
+        double result = std::numeric_limits<double>::max();
+
+        for (std::size_t repeat = 0; repeat < 5; ++repeat)
+        {
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::duration<double, std::nano>::zero();
+
+            for (std::size_t i = 0; i < SAMPLES; ++i)
+            {
+                clock_t::time_point start = clock_t::now();
+                elapsed += clock_t::now() - start;
+            }
+
+            result = std::min(result, elapsed.count() / SAMPLES);
+        }
+
+        return result;
+    }
+}
+
+
+template <count_t BUSTERS_COUNT>
+class codebusters_benchmark_t
+{
+public:
+    using player_t = codebusters_player_t<BUSTERS_COUNT>;
+    using clock_t = std::chrono::steady_clock;
+    using stage_t = void (codebusters_benchmark_t::*)();
+
+    struct stage_info_t
+    {
+        const char* name;
+        stage_t stage;
+        bool uses_tasks; // `false` if stage doesn't depend on tasks, so that it's measured once per tasks sweep
+    };
+
+    static const std::size_t STAGES_COUNT = 5;
+
+
+private:
+    // Part of bot's state changed by the stages
+    struct player_state_t
+    {
+        tracking_data_t<BUSTERS_COUNT> tracking_data;
+        task_registry_t tasks;
+        per_buster_t<assignment_t, BUSTERS_COUNT> assignments;
+        per_buster_t<assignment_t, BUSTERS_COUNT> pending_assignments;
+        per_buster_t<assignment_t, BUSTERS_COUNT> previous_assignments;
+        std::bitset<BUSTERS_COUNT> initial_assignments_done;
+        std::array<command_t, BUSTERS_COUNT> commands;
+        std::mt19937 random_engine;
+    };
+
+
+public:
+    codebusters_benchmark_t(count_t visible_ghosts, std::size_t tasks_count, unsigned int random_seed)
+        : visible_ghosts(visible_ghosts),
+        settings { 0, BUSTERS_COUNT, std::min(MAX_GHOSTS_COUNT, std::max<count_t>(8, 2 * visible_ghosts)) },
+        random_engine(random_seed),
+        first_round(-1),
+        second_round(-1),
+        player(settings, random_seed, -1)
+    {
+        generate_rounds();
+
+        player.start_game();
+
+        input_reader_t reader(first_round.data(), first_round.size());
+        input::use_reader(reader);
+        player.play_round();
+
+        for (std::size_t i = 0; i < tasks_count; ++i)
+            player.add_task(task_t::make_explore(get_random_position(), player.params.explore_factor));
+
+        player.game_data.swap_round_buffers();
+        read_round_data();
+        player.round_deadline.start(player.round_time_budget);
+    }
+
+    ~codebusters_benchmark_t()
+    {
+        input::use_default_reader();
+    }
+
+    // Ordered as stages run in round, every stage leaves state the next one expects
+    static const std::array<stage_info_t, STAGES_COUNT>& get_stages()
+    {
+        static const std::array<stage_info_t, STAGES_COUNT> stages
+        {
+            {
+                { "read_round_data", &codebusters_benchmark_t::read_round_data, false },
+                { "compute_tracking_data", &codebusters_benchmark_t::compute_tracking_data, true },
+                { "on_new_round", &codebusters_benchmark_t::on_new_round, true },
+                { "assign_tasks", &codebusters_benchmark_t::assign_tasks, true },
+                { "execute_assignments", &codebusters_benchmark_t::execute_assignments, true },
+            }
+        };
+
+        return stages;
+    }
+
+    // Runs stages preceding given one once, so that it gets state it would get in the round, and saves that state
+    void prepare_stage(std::size_t stage_index)
+    {
+        // Second round is already read
+        for (std::size_t i = 1; i < stage_index; ++i)
+            (this->*get_stages()[i].stage)();
+
+        saved_state.reset(new player_state_t { player.tracking_data, player.tasks, player.assignments, player.pending_assignments,
+            player.previous_assignments, player.initial_assignments_done, player.commands, player.random_engine });
+    }
+
+    // Every run starts from state saved by `prepare_stage`, only the stage itself is timed and its allocations counted
+    measurement_t measure(stage_t stage, std::size_t iterations, std::size_t repeats, double clock_overhead)
+    {
+        measurement_t result { std::numeric_limits<double>::max(), 0.0, 0.0, player.tasks.occupancy().size };
+        allocation_counters_t::values_t allocations { 0, 0 };
+
+        // Warm-up, so that buffers grown by the first run count neither in time nor in allocations
+        restore_state();
+        (this->*stage)();
+
+        for (std::size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::duration<double, std::nano>::zero();
+
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                restore_state();
+
+                allocation_counters_t::values_t allocations_at_start = allocation_counters_t::read_values();
+                clock_t::time_point start = clock_t::now();
+
+                (this->*stage)();
+
+                elapsed += clock_t::now() - start;
+                allocation_counters_t::values_t allocations_at_end = allocation_counters_t::read_values();
+
+                allocations.allocations += allocations_at_end.allocations - allocations_at_start.allocations;
+                allocations.bytes += allocations_at_end.bytes - allocations_at_start.bytes;
+            }
+
+            result.nanoseconds = std::min(result.nanoseconds, std::max(0.0, elapsed.count() / iterations - clock_overhead));
+        }
+
+        const double operations = static_cast<double>(iterations * repeats);
+
+        result.allocations = allocations.allocations / operations;
+        result.bytes = allocations.bytes / operations;
+
+        return result;
+    }
+
+
+private:
+    void restore_state()
+    {
+        player.tracking_data = saved_state->tracking_data;
+        player.tasks = saved_state->tasks;
+        player.assignments = saved_state->assignments;
+        player.pending_assignments = saved_state->pending_assignments;
+        player.previous_assignments = saved_state->previous_assignments;
+        player.initial_assignments_done = saved_state->initial_assignments_done;
+        player.commands = saved_state->commands;
+        player.random_engine = saved_state->random_engine;
+    }
+
+
+private: // Stages
+    void read_round_data()
+    {
+        input_reader_t reader(second_round.data(), second_round.size());
+        input::use_reader(reader);
+        input::read_round_data(player.game_data);
+    }
+
+    void compute_tracking_data()
+    {
+        player.compute_tracking_data(player.game_data.previous_entities());
+    }
+
+    void on_new_round()
+    {
+        player.on_new_round();
+    }
+
+    void assign_tasks()
+    {
+        const coord_t OUTSIDE_MAP = std::numeric_limits<coord_t>::max();
+
+        for (std::size_t i = 0; i < BUSTERS_COUNT; ++i)
+            player.scores.update_buster(i, { { OUTSIDE_MAP, OUTSIDE_MAP }, buster_t::state_t::NORMAL, -1 });
+
+        player.round_deadline.start(player.round_time_budget);
+        player.assign_tasks();
+    }
+
+    void execute_assignments()
+    {
+        player.execute_assignments();
+    }
+
+
+private: // Synthetic states
+    position_t get_random_position()
+    {
+        coord_t x = static_cast<coord_t>(random_engine() % player.game_data.map_size.x);
+        coord_t y = static_cast<coord_t>(random_engine() % player.game_data.map_size.y);
+
+        return { x, y };
+    }
+
+    position_t get_moved_position(const position_t& position)
+    {
+        const std::uint32_t range = static_cast<std::uint32_t>(game_constants_t::MOVE_RANGE);
+
+        double x = static_cast<double>(position.x) + static_cast<double>(random_engine() % (2 * range + 1)) - range;
+        double y = static_cast<double>(position.y) + static_cast<double>(random_engine() % (2 * range + 1)) - range;
+
+        return player.game_data.get_clamped_position(x, y);
+    }
+
+    static void write_entity(output_buffer_t& round, id_type id, const position_t& position, int type, int state, int value)
+    {
+        round << id << ' ' << position << ' ' << type << ' ' << state << ' ' << value << '\n';
+    }
+
+    // First round: all busters and enemies and ghosts [0, visible) are seen, own buster 0 carries a ghost which
+    // isn't on map and enemy 0 is stunned. Second round: busters moved, ghosts [visible / 2, visible / 2 + visible)
+    // are seen and every other enemy went out of sight.
+    void generate_rounds()
+    {
+        const id_type carried_ghost_id = static_cast<id_type>(settings.ghosts_count - 1);
+        const int GHOST_TYPE = -1;
+
+        std::array<position_t, 2 * BUSTERS_COUNT> busters_positions;
+        for (position_t& position : busters_positions)
+            position = get_random_position();
+
+        std::vector<position_t> ghosts_positions(visible_ghosts + visible_ghosts / 2);
+        for (position_t& position : ghosts_positions)
+            position = get_random_position();
+
+        first_round << (2 * BUSTERS_COUNT + visible_ghosts) << '\n';
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            int team = (id < BUSTERS_COUNT) ? 0 : 1;
+            int state = (id == 0) ? 1 : (id == BUSTERS_COUNT) ? 2 : 0;
+            int value = (id == 0) ? static_cast<int>(carried_ghost_id) : (id == BUSTERS_COUNT) ? 5 : -1;
+
+            write_entity(first_round, id, busters_positions[id], team, state, value);
+        }
+
+        for (id_type id = 0; id < visible_ghosts; ++id)
+            write_entity(first_round, id, ghosts_positions[id], GHOST_TYPE, 3 + (id % 3) * 12, 0);
+
+        const count_t visible_enemies = (BUSTERS_COUNT + 1) / 2;
+        second_round << (BUSTERS_COUNT + visible_enemies + visible_ghosts) << '\n';
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            if (id >= BUSTERS_COUNT && (id - BUSTERS_COUNT) % 2 != 0)
+                continue;
+
+            int team = (id < BUSTERS_COUNT) ? 0 : 1;
+            int state = (id == 0) ? 1 : (id == BUSTERS_COUNT) ? 2 : 0;
+            int value = (id == 0) ? static_cast<int>(carried_ghost_id) : (id == BUSTERS_COUNT) ? 4 : -1;
+
+            write_entity(second_round, id, get_moved_position(busters_positions[id]), team, state, value);
+        }
+
+        for (id_type id = visible_ghosts / 2; id < visible_ghosts / 2 + visible_ghosts; ++id)
+            write_entity(second_round, id, ghosts_positions[id], GHOST_TYPE, 3 + (id % 3) * 12, 0);
+    }
+
+
+private:
+    const count_t visible_ghosts;
+    const game_settings_t settings;
+    std::mt19937 random_engine; // generates synthetic state, seeded explicitly so that states are reproducible
+    output_buffer_t first_round;
+    output_buffer_t second_round;
+    player_t player;
+    std::unique_ptr<player_state_t> saved_state; // by `prepare_stage`
+};
+
+template <count_t BUSTERS_COUNT>
+const std::size_t codebusters_benchmark_t<BUSTERS_COUNT>::STAGES_COUNT;
+
+
+namespace
+{
+    struct options_t
+    {
+        std::vector<std::size_t> ghosts_counts;
+        std::vector<std::size_t> tasks_counts;
+        std::size_t iterations;
+        std::size_t repeats;
+        unsigned int random_seed;
+        const char* filter;
+        double clock_overhead; // nanoseconds subtracted from every measured run
+    };
+
+    // Tasks columns are `-` for stages which don't depend on tasks
+    void write_measurement(const char* name, count_t busters_count, count_t ghosts_count, bool uses_tasks, std::size_t tasks_count,
+        const measurement_t& measurement)
+    {
+        std::string tasks = uses_tasks ? std::to_string(tasks_count) : "-";
+        std::string resident = uses_tasks ? std::to_string(measurement.resident_tasks) : "-";
+
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-22s %7u %6u %6s %8s %12.1f %10.2f %10.1f %12.0f\n",
+            name, static_cast<unsigned int>(busters_count), static_cast<unsigned int>(ghosts_count), tasks.c_str(), resident.c_str(),
+            measurement.nanoseconds, measurement.allocations, measurement.bytes, 1e9 / measurement.nanoseconds);
+        std::cout << line;
+    }
+
+    template <count_t BUSTERS_COUNT>
+    void run_benchmarks(const options_t& options)
+    {
+        using benchmark_t = codebusters_benchmark_t<BUSTERS_COUNT>;
+
+        for (std::size_t stage_index = 0; stage_index < benchmark_t::STAGES_COUNT; ++stage_index)
+        {
+            const typename benchmark_t::stage_info_t& stage = benchmark_t::get_stages()[stage_index];
+
+            if (options.filter && std::strcmp(options.filter, stage.name) != 0)
+                continue;
+
+            for (std::size_t ghosts_count : options.ghosts_counts)
+            {
+                for (std::size_t tasks_count : options.tasks_counts)
+                {
+                    // Each state is set up anew, so that earlier stages' runs don't change it
+                    benchmark_t benchmark(static_cast<count_t>(ghosts_count), tasks_count, options.random_seed);
+                    benchmark.prepare_stage(stage_index);
+
+                    measurement_t measurement = benchmark.measure(stage.stage, options.iterations, options.repeats, options.clock_overhead);
+
+                    write_measurement(stage.name, BUSTERS_COUNT, static_cast<count_t>(ghosts_count), stage.uses_tasks, tasks_count, measurement);
+
+                    if (!stage.uses_tasks)
+                        break;
+                }
+            }
+        }
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::size_t> busters_counts { 2, 3, 4, 5 };
+    options_t options { { 0, 5, 15, 30 }, { 10, 100, 500, 2000 }, 2000, 5, DEFAULT_RANDOM_SEED, nullptr, 0.0 };
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if ((std::strcmp(argv[i], "--busters") == 0 && !parse_list(argv[i + 1], busters_counts)) ||
+            (std::strcmp(argv[i], "--ghosts") == 0 && !parse_list(argv[i + 1], options.ghosts_counts)) ||
+            (std::strcmp(argv[i], "--tasks") == 0 && !parse_list(argv[i + 1], options.tasks_counts)))
+        {
+            std::cerr << "Invalid list of numbers: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            options.iterations = std::max<std::size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--repeats") == 0)
+            options.repeats = std::max<std::size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            options.random_seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--filter") == 0)
+            options.filter = argv[i + 1];
+    }
+
+    for (std::size_t ghosts_count : options.ghosts_counts)
+    {
+        if (ghosts_count > MAX_GHOSTS_COUNT / 2)
+        {
+            std::cerr << "Unsupported number of visible ghosts: " << ghosts_count << std::endl;
+            return 1;
+        }
+    }
+
+    options.clock_overhead = get_clock_overhead();
+
+    std::printf("# %-20s %7s %6s %6s %8s %12s %10s %10s %12s\n", "stage", "busters", "ghosts", "tasks", "resident", "ns/op", "allocs/op", "bytes/op", "ops/s");
+    if (!allocation_counters_t::ENABLED)
+        std::printf("# allocations aren't counted (built with PROFILE_ALLOCATIONS=0)\n");
+    std::fflush(stdout);
+
+    for (std::size_t busters_count : busters_counts)
+    {
+        switch (busters_count)
+        {
+        case 2:
+            run_benchmarks<2>(options);
+            break;
+        case 3:
+            run_benchmarks<3>(options);
+            break;
+        case 4:
+            run_benchmarks<4>(options);
+            break;
+        case 5:
+            run_benchmarks<5>(options);
+            break;
+        default:
+            std::cerr << "Unsupported number of busters per player: " << busters_count << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -2,22 +2,36 @@
 
 #include <algorithm>
 #include <array>
+#include <bitset>
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <random>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "assignment_solver.hpp"
 #include "command.hpp"
 #include "constants.hpp"
+#include "deadline.hpp"
+#include "distance_kernels.hpp"
 #include "entity.hpp"
 #include "game_data.hpp"
 #include "input.hpp"
+#include "output_buffer.hpp"
+#include "per_buster.hpp"
+#include "phase_profiler.hpp"
+#include "score_cache.hpp"
+#include "strategy_params.hpp"
 #include "task.hpp"
+#include "task_registry.hpp"
 #include "tracking_data.hpp"
 #include "types.hpp"
 #include "utils.hpp"
+#include "watchdog.hpp"
 
 
 // Tracked informations:
@@ -46,68 +60,189 @@
 //     - how many enemies are in distance less then N
 //     - how many ghosts are in distance less then N
 
+template <count_t BUSTERS_COUNT>
+class codebusters_benchmark_t;
+
+template <count_t BUSTERS_COUNT>
 class codebusters_player_t
 {
+    // Runs single stages of round on synthetic states (see `benchmark.cpp`)
+    friend class codebusters_benchmark_t<BUSTERS_COUNT>;
+
+
+public:
+    using entities_t = round_entities_t<BUSTERS_COUNT>;
+    using phase_t = phase_profiler_t::phase_t;
+    using counter_t = phase_profiler_t::counter_t;
+
+    // Round runner of `play()` which just plays every round
+    struct plain_round_runner_t
+    {
+        template <typename round_type>
+        bool operator()(round_type round) const
+        {
+            round();
+            return true;
+        }
+    };
+
+
 public:
-    codebusters_player_t()
-        : game_data(input::read_game_data())
+    explicit codebusters_player_t(const game_settings_t& settings, unsigned int random_seed = DEFAULT_RANDOM_SEED, int output_fd = STDOUT_FILENO,
+        const strategy_params_t& params = strategy_params_t())
+        : game_data(settings),
+        params(params),
+        tasks(game_data.map_size, static_cast<coord_t>(game_data.MOVE_RANGE), MAX_TASKS_COUNT, explore_merge_distance),
+        scores(MAX_TASKS_COUNT),
+        pruned_candidates_counts(),
+        scored_candidates_count(0),
+        output(output_fd),
+        random_engine(random_seed),
+        use_watchdog(USE_WATCHDOG && output_fd >= 0),
+        fallback_output(output_fd),
+        watchdog([this]() { write_fallback_commands(); })
     {
+        prepare_buster_messages();
     }
 
     void play()
     {
-        const count_t ROUND_COUNT = 250;
+        play(plain_round_runner_t());
+    }
 
-        assign_initial_tasks();
+    // Plays whole game with every round run by `run_round(round)`, where calling `round()` plays it (e.g. replay
+    // times it), game stops early once `run_round` returns `false`
+    template <typename round_runner_type>
+    void play(round_runner_type run_round)
+    {
+        start_game();
 
-        while (game_data.round < ROUND_COUNT)
+        while (game_data.round < game_constants_t::ROUND_COUNT && input::has_round_data())
         {
-            process_round_data();
+            if (!run_round([this]() { play_round(); }))
+                break;
+        }
+
+        finish_game();
+    }
+
+    // Steps of `play()`, so that the game can also be driven round by round from outside (e.g. by in-process
+    // referee), with every round's input provided through `input::use_reader`
+
+    void start_game()
+    {
+        assign_initial_tasks();
+    }
 
-            on_new_round();
+    // Once watchdog wrote fallback commands, rest of the round is given up between stages, since next round's
+    // input may already be waiting and its time running
+    void play_round()
+    {
+        profiler.measure(phase_t::ROUND, [this]() {
+            profiler.measure(phase_t::PROCESS_ROUND_DATA, [this]() { process_round_data(); });
+            if (is_round_given_up())
+                return;
 
-            assign_tasks();
-            execute_assignments();
+            profiler.measure(phase_t::ON_NEW_ROUND, [this]() { on_new_round(); });
+            if (is_round_given_up())
+                return;
 
-            move_to_next_round();
-        }
+            profiler.measure(phase_t::ASSIGN_TASKS, [this]() { assign_tasks(); });
+            if (is_round_given_up())
+                return;
+
+            profiler.measure(phase_t::EXECUTE_ASSIGNMENTS, [this]() { execute_assignments(); });
+            profiler.measure(phase_t::WRITE_COMMANDS, [this]() { write_commands(); });
+        });
+
+        profiler.end_round();
+        move_to_next_round();
+    }
+
+    void finish_game()
+    {
+        if (REPORT_STATISTICS)
+            report_statistics();
+
+        profiler.report(std::cerr);
+    }
+
+
+    const std::array<command_t, BUSTERS_COUNT>& get_commands() const
+    {
+        return commands;
+    }
+
+    const tracking_data_t<BUSTERS_COUNT>& get_tracking_data() const
+    {
+        return tracking_data;
+    }
+
+    count_t get_points() const
+    {
+        return game_data.points;
+    }
+
+    // Overrides time budget of every round (e.g. tiny one forces watchdog's fallback commands in checks)
+    void set_round_time_budget(std::chrono::microseconds budget)
+    {
+        round_time_budget = budget;
     }
 
 
 private: // General flow methods
     void process_round_data()
     {
-        game_data_t previous_game_data = game_data;
-        game_data.prepare_for_next_round();
+        game_data.swap_round_buffers();
+
+        profiler.measure(phase_t::READ_ROUND_DATA, [this]() { input::read_round_data(game_data); });
 
-        input::read_round_data(game_data);
+        // After fallback commands judge sends next input right away, so this round's time runs since they were written
+        if (use_watchdog && watchdog.has_fired())
+            round_deadline.start(watchdog.get_fired_at(), round_time_budget);
+        else
+            round_deadline.start(round_time_budget);
+
+        if (use_watchdog)
+        {
+            prepare_fallback_commands();
+            watchdog.arm(round_deadline.get_expiration());
+        }
 
-        compute_tracking_data((game_data.round > 0) ? previous_game_data : game_data);
+        compute_tracking_data((game_data.round > 0) ? game_data.previous_entities() : game_data.entities());
     }
 
-    void compute_tracking_data(const game_data_t& previous_game_data)
+    bool is_round_given_up()
     {
-        compute_appeared_ghosts(previous_game_data); // finds if any present ghost just appeared, and if so then if it's first time then mark symmetry ghost
-        compute_disappeared_ghosts(previous_game_data); // if ghost went out of scope, save information about him for later
-        compute_stun_tracking_data(previous_game_data); // computes anything stun-related
-        compute_appeared_enemies(previous_game_data); // finds any enemies that just came on screen
-        compute_disappeared_enemies(previous_game_data); // discovers which enemies just went out of scope
-        compute_busters_start_carrying_ghosts(previous_game_data); // find which busters started to carry ghost
-        compute_busters_stop_carrying_ghosts(previous_game_data); // find which busters stopped carrying ghost
-        compute_lost_ghosts(previous_game_data); // find if any buster lost his ghost while carring it
+        return (use_watchdog && watchdog.has_fired());
+    }
+
+    // Always runs whole, since partially applied events would leave tasks out of sync with the game
+    // (time left is checked by stages after it)
+    void compute_tracking_data(const entities_t& previous_game_data)
+    {
+        profiler.measure(phase_t::COMPUTE_APPEARED_GHOSTS, [&]() { compute_appeared_ghosts(previous_game_data); }); // finds if any present ghost just appeared, and if so then if it's first time then mark symmetry ghost
+        profiler.measure(phase_t::COMPUTE_DISAPPEARED_GHOSTS, [&]() { compute_disappeared_ghosts(previous_game_data); }); // if ghost went out of scope, save information about him for later
+        profiler.measure(phase_t::COMPUTE_STUN_TRACKING_DATA, [&]() { compute_stun_tracking_data(previous_game_data); }); // computes anything stun-related
+        profiler.measure(phase_t::COMPUTE_APPEARED_ENEMIES, [&]() { compute_appeared_enemies(previous_game_data); }); // finds any enemies that just came on screen
+        profiler.measure(phase_t::COMPUTE_DISAPPEARED_ENEMIES, [&]() { compute_disappeared_enemies(previous_game_data); }); // discovers which enemies just went out of scope
+        profiler.measure(phase_t::COMPUTE_BUSTERS_START_CARRYING_GHOSTS, [&]() { compute_busters_start_carrying_ghosts(previous_game_data); }); // find which busters started to carry ghost
+        profiler.measure(phase_t::COMPUTE_BUSTERS_STOP_CARRYING_GHOSTS, [&]() { compute_busters_stop_carrying_ghosts(previous_game_data); }); // find which busters stopped carrying ghost
+        profiler.measure(phase_t::COMPUTE_LOST_GHOSTS, [&]() { compute_lost_ghosts(previous_game_data); }); // find if any buster lost his ghost while carring it
     }
 
     void assign_tasks()
     {
+        previous_assignments = assignments;
         assignments.clear();
 
         // Create initial assignments if not done yet (they will be marked as pending assignments)
         count_t i = 0;
-        for (const auto& id_buster_pair : game_data.busters)
+        for (const auto& id_buster_pair : game_data.busters())
         {
             const buster_t& buster = id_buster_pair.second;
 
-            if (initial_assignments_done.find(buster.id) == initial_assignments_done.end())
+            if (!initial_assignments_done.test(game_data.get_buster_index(buster.id)))
                 do_initial_assignment(buster, initial_goal_positions.at(game_data.busters_count)[i]);
 
             ++i;
@@ -116,114 +251,161 @@ private: // General flow methods
         // Add pending assignments
         assign_pending_assignments();
 
-        // Compute assignments
-        std::vector<assignment_t> current_assignments;
-        for (const task_t& task : tasks)
+        // Without enough time left for scoring, busters keep their last round's assignments
+        if (!round_deadline.has_at_least(scoring_time_reserve))
         {
-            for (const auto& id_buster_pair : game_data.busters)
-            {
-                const buster_t& buster = id_buster_pair.second;
-                current_assignments.push_back(assignment_t { task, buster.id, get_score_for_assignment(buster, task) });
-            }
+            assign_previous_assignments();
+            return;
         }
 
-        // Sort assignments for best-is-first order
-        std::sort(std::begin(current_assignments), std::end(current_assignments));
-
-        // Comput best-for-each-buster
-        std::vector<position_t> explore_locations; // mark those when buster already will go there
-        std::vector<id_type> stun_targets; // mark targets already stunned
-        std::map<id_type, assignment_t> current_best_assignments;
-        for (std::size_t i = 0; i < current_assignments.size(); ++i)
+        // Busters without assignment yet (they might have from pending assignments) get one from the solver
+        unassigned_busters.clear();
+        for (const auto& id_buster_pair : game_data.busters())
         {
-            if (current_best_assignments.size() == game_data.busters_count)
-                break;
+            const buster_t& buster = id_buster_pair.second;
+            std::size_t buster_index = game_data.get_buster_index(buster.id);
+
+            scores.update_buster(buster_index, get_score_inputs_of_buster(buster));
+
+            if (!assignments.contains(buster_index))
+                unassigned_busters.push_back(buster);
+        }
+
+        // Score every plausible (buster, task) pair, tasks of each type in one batch
+        profiler.count(counter_t::TASKS, tasks.size());
+        profiler.measure(phase_t::SCORING, [this]() {
+            prepare_candidate_filters();
+
+            tasks_handles.clear();
+            solver.reset(unassigned_busters.size(), tasks.size());
+
+            score_tasks_of_type(task_t::type_t::BUST, &codebusters_player_t::get_score_for_bust_assignment);
+            score_tasks_of_type(task_t::type_t::COVER, &codebusters_player_t::get_score_for_cover_assignment);
+            score_tasks_of_type(task_t::type_t::RETURN, &codebusters_player_t::get_score_for_return_assignment);
+            score_tasks_of_type(task_t::type_t::STUN, &codebusters_player_t::get_score_for_stun_assignment);
+            score_explore_tasks();
+        });
+
+        profiler.measure(phase_t::SORTING, [this]() { solver.sort_candidates(); });
 
-            if (current_best_assignments.count(current_assignments[i].owner) == 0)
+        // Compute best assignments for all busters together
+        profiler.measure(phase_t::SELECTION, [this]() {
+            const double explore_conflict_distance = game_data.MOVE_RANGE * params.explore_conflict_moves;
+
+            solver.solve([this, explore_conflict_distance](std::size_t first, std::size_t second) {
+                const task_t& first_task = tasks.get(tasks_handles[first]);
+                const task_t& second_task = tasks.get(tasks_handles[second]);
+
+                return (first_task.type == task_t::type_t::EXPLORE &&
+                    second_task.type == task_t::type_t::EXPLORE &&
+                    is_closer_than(first_task.position, second_task.position, explore_conflict_distance));
+            }, std::min(assignment_solver_t::clock_t::now() + assignment_time_budget, round_deadline.get_expiration() - execution_time_reserve));
+
+            for (std::size_t b = 0; b < unassigned_busters.size(); ++b)
             {
-                const task_t& current_task = current_assignments[i].task;
-                bool allowed = true;
+                const buster_t& buster = unassigned_busters[b];
+                std::size_t t = solver.get_choice(b);
 
-                // Forbid explorations where one buster is already going there
-                if (current_task.type == task_t::type_t::EXPLORE)
+                if (t != assignment_solver_t::UNASSIGNED)
                 {
-                    for (const auto& explore_location : explore_locations)
-                    {
-                        if (distance_between(current_task.position, explore_location) < game_data.MOVE_RANGE * 1.5) // TODO experimental factor
-                        {
-                            allowed = false;
-                            break;
-                        }
-                    }
-
-                    if (allowed)
-                        explore_locations.push_back(current_task.position);
+                    assignments.insert(game_data.get_buster_index(buster.id), assignment_t { tasks.get(tasks_handles[t]), buster.id, solver.score(b, t) });
+                    profiler.count(counter_t::ASSIGNMENTS_CHOSEN, 1);
                 }
-
-                // Forbid stunning enemy multiple times at same round (won't stun in next either)
-                else if (current_task.type == task_t::type_t::STUN)
+                else
                 {
-                    for (const auto& stun_target : stun_targets)
-                    {
-                        if (stun_target == current_task.id)
-                        {
-                            allowed = false;
-                            break;
-                        }
-                    }
-
-                    if (allowed)
-                        stun_targets.push_back(current_task.id);
+                    assignments.insert(game_data.get_buster_index(buster.id), assignment_t());
                 }
-
-                if (allowed)
-                    current_best_assignments[current_assignments[i].owner] = current_assignments[i];
             }
-        }
-
-        // Assign task if buster doesn't have any yet (he might have from pending assignments)
-        for (const auto& id_buster_pair : game_data.busters)
-        {
-            const auto& buster = id_buster_pair.second;
-
-            auto buster_assignment = assignments.find(buster.id);
-            if (buster_assignment == assignments.end())
-                assignments.insert({ buster.id, current_best_assignments[buster.id] });
-        }
+        });
     }
 
     void do_initial_assignment(const buster_t& buster, const position_t& initial_assignment_position)
     {
-        double distance = distance_between(buster, initial_assignment_position);
-
-        if (distance < (game_data.MOVE_RANGE / 2.0))
+        if (is_closer_than(buster.position, initial_assignment_position, game_data.MOVE_RANGE / 2.0))
         {
             auto radar_task = task_t::make_radar();
             auto radar_assignment = assignment_t { radar_task, buster.id, 0.0 };
-            pending_assignments.insert({ buster.id, radar_assignment });
+            pending_assignments.insert(game_data.get_buster_index(buster.id), radar_assignment);
 
-            initial_assignments_done.insert(buster.id);
+            initial_assignments_done.set(game_data.get_buster_index(buster.id));
         }
         else
         {
             auto move_to_radar_task = task_t::make_explore(initial_assignment_position, 0.0);
             auto move_to_radar_assignment = assignment_t { move_to_radar_task, buster.id, 0.0 };
 
-            pending_assignments.insert({ buster.id, move_to_radar_assignment });
+            pending_assignments.insert(game_data.get_buster_index(buster.id), move_to_radar_assignment);
         }
     }
 
     void assign_pending_assignments()
     {
-        assignments = pending_assignments;
+        for (const auto& id_buster_pair : game_data.busters())
+        {
+            const buster_t& buster = id_buster_pair.second;
+            std::size_t buster_index = game_data.get_buster_index(buster.id);
+
+            if (!pending_assignments.contains(buster_index))
+                continue;
+
+            // Target may be already gone (e.g. ejected ghost caught by enemy), then buster gets a new assignment
+            const assignment_t& pending_assignment = pending_assignments.get(buster_index);
+            if (pending_assignment.task.type == task_t::type_t::RADAR || can_execute_task(buster, pending_assignment.task))
+                assignments.set(buster_index, pending_assignment);
+        }
+
         pending_assignments.clear();
     }
 
+    // Cheap path for busters without assignment: last round's assignment if it's still executable,
+    // otherwise returning carried ghost or default exploration
+    void assign_previous_assignments()
+    {
+        for (const auto& id_buster_pair : game_data.busters())
+        {
+            const buster_t& buster = id_buster_pair.second;
+            std::size_t buster_index = game_data.get_buster_index(buster.id);
+
+            if (previous_assignments.contains(buster_index) && can_execute_task(buster, previous_assignments.get(buster_index).task))
+                assignments.insert(buster_index, previous_assignments.get(buster_index));
+            else if (buster.state == buster_t::state_t::CARRY_GHOST)
+                assignments.insert(buster_index, assignment_t { task_t::make_return(), buster.id, 0.0 });
+            else
+                assignments.insert(buster_index, assignment_t());
+        }
+    }
+
+    bool can_execute_task(const buster_t& buster, const task_t& task) const
+    {
+        switch (task.type)
+        {
+        case task_t::type_t::BUST:
+            return (game_data.ghosts().count(task.id) > 0);
+
+        case task_t::type_t::STUN:
+            return (game_data.enemies().count(task.id) > 0);
+
+        case task_t::type_t::COVER:
+            return (game_data.busters().count(task.id) > 0);
+
+        case task_t::type_t::RETURN:
+            return (buster.state == buster_t::state_t::CARRY_GHOST);
+
+        case task_t::type_t::RADAR:
+            return false; // radar is used only once
+
+        case task_t::type_t::EXPLORE:
+            break;
+        }
+
+        return true;
+    }
+
     void execute_assignments()
     {
         // TODO: if one is ejectng, other can check if it can go closer to base
-        for (const auto& id_buster_pair : game_data.busters)
-            execute_task(id_buster_pair.second, assignments[id_buster_pair.first].task);
+        for (const auto& id_buster_pair : game_data.busters())
+            execute_task(id_buster_pair.second, assignments.get(game_data.get_buster_index(id_buster_pair.first)).task);
     }
 
     void move_to_next_round()
@@ -233,57 +415,104 @@ private: // General flow methods
 
 
 private: // Command execution
+    // Command's bookkeeping (radar and stun usage, scored points) is applied only once it's actually written,
+    // see `write_commands`
     void execute_command(const command_t& command)
     {
-        switch (command.type)
+        commands[game_data.get_buster_index(command.owner_id)] = command;
+    }
+
+    void execute_specials(const command_t& command)
+    {
+        using specials_t = void (codebusters_player_t::*)(const command_t&);
+
+        // Ordered as `command_t::type_t` values
+        static const std::array<specials_t, command_t::TYPES_COUNT> specials
         {
-        case command_t::type_t::MOVE:
-            execute_specials_for_move_command(static_cast<const move_command_t&>(command));
-            break;
-        case command_t::type_t::BUST:
-            execute_specials_for_bust_command(static_cast<const bust_command_t&>(command));
-            break;
-        case command_t::type_t::STUN:
-            execute_specials_for_stun_command(static_cast<const stun_command_t&>(command));
-            break;
-        case command_t::type_t::RELEASE:
-            execute_specials_for_release_command(static_cast<const release_command_t&>(command));
-            break;
-        case command_t::type_t::RADAR:
-            execute_specials_for_radar_command(static_cast<const radar_command_t&>(command));
-            break;
-        case command_t::type_t::EJECT:
-            execute_specials_for_eject_command(static_cast<const eject_command_t&>(command));
+            {
+                &codebusters_player_t::execute_specials_for_bust_command,
+                &codebusters_player_t::execute_specials_for_eject_command,
+                &codebusters_player_t::execute_specials_for_move_command,
+                &codebusters_player_t::execute_specials_for_radar_command,
+                &codebusters_player_t::execute_specials_for_release_command,
+                &codebusters_player_t::execute_specials_for_stun_command,
+            }
+        };
+
+        (this->*specials[static_cast<std::size_t>(command.type)])(command);
+    }
+
+    void write_commands()
+    {
+        // Fallback commands were already written for this round, none of own commands took effect
+        if (use_watchdog && !watchdog.disarm())
+            return;
+
+        for (std::size_t i = 0; i < BUSTERS_COUNT; ++i)
+        {
+            execute_specials(commands[i]);
+            commands[i].write(output, buster_messages[commands[i].owner_id]);
+        }
+
+        output.flush();
+    }
+
+    // Commands written by watchdog when round isn't finished in time: carriers head to base, others stay in place
+    void prepare_fallback_commands()
+    {
+        for (const auto& id_buster_pair : game_data.busters())
+        {
+            const buster_t& buster = id_buster_pair.second;
+            std::size_t buster_index = game_data.get_buster_index(buster.id);
+
+            if (buster.state == buster_t::state_t::CARRY_GHOST)
+                fallback_commands[buster_index] = command_t::make_move(buster.id, game_data.base_position.own);
+            else
+                fallback_commands[buster_index] = command_t::make_move(buster.id, buster.position);
         }
+    }
+
+    // Runs on watchdog's thread
+    void write_fallback_commands()
+    {
+        for (std::size_t i = 0; i < BUSTERS_COUNT; ++i)
+            fallback_commands[i].write(fallback_output, buster_messages[fallback_commands[i].owner_id]);
+
+        fallback_output.flush();
+    }
 
-        command.execute("Buster #" + std::to_string(command.owner_id));
+    void prepare_buster_messages()
+    {
+        // Buster ids are in range [0, 2 * busters_count) regardless of team
+        for (id_type id = 0; id < buster_messages.size(); ++id)
+            buster_messages[id] = "Buster #" + std::to_string(id);
     }
 
-    void execute_specials_for_move_command(const move_command_t& move_command)
+    void execute_specials_for_move_command(const command_t& move_command)
     {
     }
 
-    void execute_specials_for_bust_command(const bust_command_t& bust_command)
+    void execute_specials_for_bust_command(const command_t& bust_command)
     {
     }
 
-    void execute_specials_for_stun_command(const stun_command_t& stun_command)
+    void execute_specials_for_stun_command(const command_t& stun_command)
     {
         tracking_data.buster_stun_usage[stun_command.owner_id] = game_data.round;
-        tracking_data.enemy_stunned_since[stun_command.enemy_id] = game_data.round;
+        tracking_data.enemy_stunned_since[stun_command.target_id] = game_data.round;
     }
 
-    void execute_specials_for_release_command(const release_command_t& release_command)
+    void execute_specials_for_release_command(const command_t& release_command)
     {
         game_data.count_new_point();
     }
 
-    void execute_specials_for_radar_command(const radar_command_t& radar_command)
+    void execute_specials_for_radar_command(const command_t& radar_command)
     {
-        tracking_data.radar_usage.insert(radar_command.owner_id);
+        tracking_data.radar_usage.set(radar_command.owner_id);
     }
 
-    void execute_specials_for_eject_command(const eject_command_t& eject_command)
+    void execute_specials_for_eject_command(const command_t& eject_command)
     {
     }
 
@@ -321,71 +550,72 @@ private: // Task execution
 
     void execute_bust_task(const buster_t& buster, const task_t& task)
     {
-        const ghost_t& ghost = game_data.ghosts.at(task.id);
-        double distance = distance_between(buster, ghost.position);
+        const ghost_t& ghost = game_data.ghosts().at(task.id);
+        std::int64_t squared_distance = squared_distance_between(buster.position, ghost.position);
 
-        if (distance < game_data.BUST_RANGE_MIN)
-            execute_command(move_command_t {
+        if (squared_distance < squared_range(game_data.BUST_RANGE_MIN))
+            execute_command(command_t::make_move(
             buster.id,
-            game_data.get_position_in_range(game_data.base_position.own, ghost.position, game_data.BUST_RANGE_MIN + 10.0) });
-        else if (game_data.BUST_RANGE_MAX < distance)
-            execute_command(move_command_t {
+            game_data.get_position_in_range(game_data.base_position.own, ghost.position, game_data.BUST_RANGE_MIN + 10.0)));
+        else if (squared_range(game_data.BUST_RANGE_MAX) < squared_distance)
+            execute_command(command_t::make_move(
             buster.id,
-            game_data.get_position_in_range(buster.position, ghost.position, game_data.BUST_RANGE_MIN + 10.0) });
+            game_data.get_position_in_range(buster.position, ghost.position, game_data.BUST_RANGE_MIN + 10.0)));
         else
-            execute_command(bust_command_t { buster.id, ghost.id });
+            execute_command(command_t::make_bust(buster.id, ghost.id));
     }
 
     void execute_cover_task(const buster_t& buster, const task_t& task)
     {
-        const buster_t& carrier = game_data.busters.at(task.id);
-        execute_command(move_command_t { buster.id, game_data.get_position_in_range(buster.position, carrier.position, game_data.BUST_RANGE_MIN - 10.0) });
+        const buster_t& carrier = game_data.busters().at(task.id);
+        execute_command(command_t::make_move(buster.id, game_data.get_position_in_range(buster.position, carrier.position, game_data.BUST_RANGE_MIN - 10.0)));
     }
 
     void execute_explore_task(const buster_t& buster, const task_t& task)
     {
-        execute_command(move_command_t { buster.id, task.position });
+        execute_command(command_t::make_move(buster.id, task.position));
     }
 
     void execute_stun_task(const buster_t& buster, const task_t& task)
     {
-        const buster_t& enemy = game_data.enemies.at(task.id);
-        double distance = distance_between(buster, enemy);
-
-        if (distance <= game_data.STUN_RANGE)
-            execute_command(stun_command_t { buster.id, task.id });
+        const buster_t& enemy = game_data.enemies().at(task.id);
+        if (is_within_range(buster.position, enemy.position, game_data.STUN_RANGE))
+            execute_command(command_t::make_stun(buster.id, task.id));
         else
-            execute_command(move_command_t { buster.id, enemy.position });
+            execute_command(command_t::make_move(buster.id, enemy.position));
     }
 
     void execute_return_task(const buster_t& buster, const task_t& task)
     {
         if (game_data.is_in_base_range(buster))
         {
-            execute_command(release_command_t { buster.id });
+            execute_command(command_t::make_release(buster.id));
+            return;
         }
-        else if (can_eject_to_friend(buster))
-        {
-            eject_command_t::params_t eject_params;
+
+        command_t::eject_params_t eject_params { buster.position, buster.id };
+        if (can_eject_to_friend(buster))
             eject_params = get_best_eject_params(buster);
 
+        if (eject_params.buster_id != buster.id)
+        {
             // Eject to friendly buster
-            execute_command(eject_command_t { buster.id, eject_params.position });
+            execute_command(command_t::make_eject(buster.id, eject_params.position));
 
             // Add assignment for friendly buster
             auto bust_task = task_t::make_bust(static_cast<id_type>(buster.value));
             auto bust_assignment = assignment_t { bust_task, eject_params.buster_id, 0.0 };
-            pending_assignments.insert({ eject_params.buster_id, bust_assignment });
+            pending_assignments.insert(game_data.get_buster_index(eject_params.buster_id), bust_assignment);
         }
         else
         {
-            execute_command(move_command_t { buster.id, game_data.get_position_in_range(buster.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE - 10.0) });
+            execute_command(command_t::make_move(buster.id, game_data.get_position_in_range(buster.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE - 10.0)));
         }
     }
 
     void execute_radar_task(const buster_t& buster, const task_t& task)
     {
-        execute_command(radar_command_t { buster.id });
+        execute_command(command_t::make_radar(buster.id));
     }
 
 
@@ -393,36 +623,37 @@ private: // Task helper methods
 
     // Conditions for buster A to eject to friend:
     // - there is a buster B between A and A's base
-    //   - distance(A,B) <= 4320 (1760 + 1760 + 800), TODO: check if B can't move earlier to this location
+    //   - distance(A,B) <= `eject_friend_distance` (1760 + 1760 + 800), TODO: check if B can't move earlier to this location
+    //     (only busters within this distance are taken from spatial index)
     // - B has less moves to base then A (at least two moves less)
     // - B is in noraml state or busting a ghost with at least 5 stamina
     // - TODO: (OPTIONAL) B is relatively safe (no enemies in (MOVE_RANGE + STUN_RANGE) range)
     bool can_eject_to_friend(const buster_t& buster)
     {
-        for (const auto& id_buster_pair : game_data.busters)
+        position_t buster_target_position = game_data.get_position_in_range(buster.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE);
+        count_t moves_from_buster = moves_from_squared_distance(squared_distance_between(buster.position, buster_target_position));
+
+        for (id_type other_id : game_data.get_busters_within_range(buster.position, params.eject_friend_distance))
         {
-            const auto& other = id_buster_pair.second;
+            const buster_t other = game_data.busters().at(other_id);
 
             // Can't pass it to yourself
             if (other.id == buster.id)
                 continue;
 
             bool can_pass_to_other = true;
-            can_pass_to_other &= (distance_between(buster, other) <= 4320.0);
 
-            position_t buster_target_position = game_data.get_position_in_range(buster.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE);
             position_t other_target_position = game_data.get_position_in_range(other.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE);
-            count_t moves_from_buster = moves_from_distance(distance_between(buster, buster_target_position));
-            count_t moves_from_other = moves_from_distance(distance_between(other, other_target_position));
-            can_pass_to_other &= (moves_from_other + 2 < moves_from_buster);
+            count_t moves_from_other = moves_from_squared_distance(squared_distance_between(other.position, other_target_position));
+            can_pass_to_other &= (moves_from_other + params.eject_min_moves_saved < moves_from_buster);
 
 
             bool state_requirement = false;
-            count_t min_busting_stamina = 6;
-            count_t max_STUN_TIMEOUT = 2;
+            factor_t min_busting_stamina = params.eject_min_busting_stamina;
+            factor_t max_STUN_TIMEOUT = params.eject_max_stunned_timeout;
             id_type busting_ghost_id = static_cast<id_type>(other.value);
             state_requirement |= (other.state == buster_t::state_t::NORMAL);
-            state_requirement |= (other.state == buster_t::state_t::BUSTING_GHOST && game_data.ghosts.at(busting_ghost_id).stamina >= min_busting_stamina);
+            state_requirement |= (other.state == buster_t::state_t::BUSTING_GHOST && game_data.ghosts().at(busting_ghost_id).stamina >= min_busting_stamina);
             state_requirement |= (other.state == buster_t::state_t::STUNNED && get_stunned_timeout(other) <= max_STUN_TIMEOUT);
             can_pass_to_other &= state_requirement;
 
@@ -436,35 +667,35 @@ private: // Task helper methods
         return false;
     }
 
-    eject_command_t::params_t get_best_eject_params(const buster_t& buster)
+    command_t::eject_params_t get_best_eject_params(const buster_t& buster)
     {
         count_t best_other_least_moves_to_base = 99999;
-        eject_command_t::params_t best_other;
+        command_t::eject_params_t best_other { buster.position, buster.id }; // own id if nobody qualifies (stricter stun requirement than in `can_eject_to_friend`)
+
+        position_t buster_target_position = game_data.get_position_in_range(buster.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE);
+        count_t moves_from_buster = moves_from_squared_distance(squared_distance_between(buster.position, buster_target_position));
 
-        for (const auto& id_buster_pair : game_data.busters)
+        for (id_type other_id : game_data.get_busters_within_range(buster.position, params.eject_friend_distance))
         {
-            const auto& other = id_buster_pair.second;
+            const buster_t other = game_data.busters().at(other_id);
 
             // Can't pass it to yourself
             if (other.id == buster.id)
                 continue;
 
             bool can_pass_to_other = true;
-            can_pass_to_other &= (distance_between(buster, other) <= 4320.0);
 
-            position_t buster_target_position = game_data.get_position_in_range(buster.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE);
             position_t other_target_position = game_data.get_position_in_range(other.position, game_data.base_position.own, game_data.BASE_RELEASE_RANGE);
-            count_t moves_from_buster = moves_from_distance(distance_between(buster, buster_target_position));
-            count_t moves_from_other = moves_from_distance(distance_between(other, other_target_position));
-            can_pass_to_other &= (moves_from_other + 2 < moves_from_buster);
+            count_t moves_from_other = moves_from_squared_distance(squared_distance_between(other.position, other_target_position));
+            can_pass_to_other &= (moves_from_other + params.eject_min_moves_saved < moves_from_buster);
 
 
             bool state_requirement = false;
-            count_t min_busting_stamina = 6;
-            count_t max_STUN_TIMEOUT = 1;
+            factor_t min_busting_stamina = params.eject_min_busting_stamina;
+            factor_t max_STUN_TIMEOUT = params.eject_target_max_stunned_timeout;
             id_type busting_ghost_id = static_cast<id_type>(other.value);
             state_requirement |= (other.state == buster_t::state_t::NORMAL);
-            state_requirement |= (other.state == buster_t::state_t::BUSTING_GHOST && game_data.ghosts.at(busting_ghost_id).stamina >= min_busting_stamina);
+            state_requirement |= (other.state == buster_t::state_t::BUSTING_GHOST && game_data.ghosts().at(busting_ghost_id).stamina >= min_busting_stamina);
             state_requirement |= (other.state == buster_t::state_t::STUNNED && get_stunned_timeout(other) <= max_STUN_TIMEOUT);
             can_pass_to_other &= state_requirement;
 
@@ -484,120 +715,291 @@ private: // Task helper methods
         return best_other;
     }
 
-    void delete_tasks(task_t::type_t type, const position_t& near_position, double near_distance = 500.0)
+    void add_task(const task_t& task)
+    {
+        tasks.insert(task, game_data.round);
+    }
+
+    void delete_explore_tasks(const position_t& near_position, double near_distance = 500.0)
     {
-        tasks.erase(
-            std::remove_if(
-            tasks.begin(),
-            tasks.end(),
-            [type, near_position, near_distance](const task_t& task) {
-            return (task.type == type && distance_between(task.position, near_position) <= near_distance);
-        }),
-            tasks.end());
+        tasks.erase_explore_near(near_position, near_distance);
     }
 
     void delete_tasks(task_t::type_t type, id_type id)
     {
-        tasks.erase(
-            std::remove_if(
-            tasks.begin(),
-            tasks.end(),
-            [type, id](const task_t& task) {
-            return (task.type == type && task.id == id);
-        }),
-            tasks.end());
+        tasks.erase(type, id);
     }
 
     count_t get_tasks_count_of_type(task_t::type_t type)
     {
-        count_t result = 0;
-
-        for (const auto& task : tasks)
-        {
-            if (task.type == type)
-                ++result;
-        }
-
-        return result;
+        return tasks.count(type);
     }
 
     void insert_random_explore_tasks(count_t count)
     {
         for (count_t i = 0; i < count; ++i)
         {
-            coord_t x = (std::rand() % game_data.map_size.x);
-            coord_t y = (std::rand() % game_data.map_size.y);
+            coord_t x = (random_engine() % game_data.map_size.x);
+            coord_t y = (random_engine() % game_data.map_size.y);
 
-            tasks.push_back(task_t::make_explore({ x, y }, explore_factor));
+            add_task(task_t::make_explore({ x, y }, params.explore_factor));
         }
     }
 
     void assign_initial_tasks()
     {
         insert_random_explore_tasks(50);
-        tasks.push_back(task_t::make_return());
+        add_task(task_t::make_return());
+    }
+
+    void report_statistics() const
+    {
+        task_registry_t::occupancy_t occupancy = tasks.occupancy();
+
+        std::cerr << "tasks: " << occupancy.size << "/" << occupancy.capacity << " (peak " << occupancy.peak_size << ")";
+        std::cerr << " explore " << occupancy.counts[static_cast<std::size_t>(task_t::type_t::EXPLORE)];
+        std::cerr << " bust " << occupancy.counts[static_cast<std::size_t>(task_t::type_t::BUST)];
+        std::cerr << " stun " << occupancy.counts[static_cast<std::size_t>(task_t::type_t::STUN)];
+        std::cerr << " cover " << occupancy.counts[static_cast<std::size_t>(task_t::type_t::COVER)];
+        std::cerr << ", deduplicated " << occupancy.deduplicated;
+        std::cerr << " evicted " << occupancy.evicted;
+        std::cerr << " expired " << occupancy.expired << std::endl;
+
+        std::cerr << "candidates: scored " << scored_candidates_count;
+        std::cerr << ", pruned by buster state " << pruned_candidates_counts[static_cast<std::size_t>(candidate_filter_t::BUSTER_STATE)];
+        std::cerr << " target state " << pruned_candidates_counts[static_cast<std::size_t>(candidate_filter_t::TARGET_STATE)];
+        std::cerr << " stun cooldown " << pruned_candidates_counts[static_cast<std::size_t>(candidate_filter_t::STUN_COOLDOWN)];
+        std::cerr << " distance " << pruned_candidates_counts[static_cast<std::size_t>(candidate_filter_t::DISTANCE)] << std::endl;
     }
 
 
 private: // Scoring assignments
-    factor_t get_score_for_assignment(const buster_t& buster, const task_t& task)
+    using scoring_function_t = factor_t (codebusters_player_t::*)(const buster_t&, const task_t&);
+
+    enum class candidate_filter_t
+    {
+        BUSTER_STATE,
+        TARGET_STATE,
+        STUN_COOLDOWN,
+        DISTANCE,
+        NONE,
+    };
+
+    static const std::size_t CANDIDATE_FILTERS_COUNT = 4;
+
+    typename score_cache_t<BUSTERS_COUNT>::buster_inputs_t get_score_inputs_of_buster(const buster_t& buster) const
     {
+        return { buster.position, buster.state, buster.value };
+    }
+
+    // Inputs of scores of given task, see `get_score_for_*_assignment` for what each type depends on
+    typename score_cache_t<BUSTERS_COUNT>::task_inputs_t get_score_inputs_of_task(const task_t& task, task_registry_t::handle_t handle) const
+    {
+        typename score_cache_t<BUSTERS_COUNT>::task_inputs_t inputs { tasks.version(handle), task.position, 0, static_cast<value_t>(game_data.points), false };
+
         switch (task.type)
         {
         case task_t::type_t::BUST:
-            return get_score_for_bust_assignment(buster, task);
+            if (game_data.ghosts().count(task.id) > 0)
+            {
+                const ghost_t ghost = game_data.ghosts().at(task.id);
+                inputs.target_position = ghost.position;
+                inputs.target_value = static_cast<value_t>(ghost.stamina);
+            }
+            else
+            {
+                inputs.volatile_inputs = true;
+            }
+            break;
 
         case task_t::type_t::COVER:
-            return get_score_for_cover_assignment(buster, task);
-
-        case task_t::type_t::EXPLORE:
-            return get_score_for_explore_assignment(buster, task);
+            if (game_data.busters().count(task.id) > 0)
+                inputs.target_position = game_data.busters().at(task.id).position;
+            else
+                inputs.volatile_inputs = true;
+            break;
 
-        case task_t::type_t::STUN:
-            return get_score_for_stun_assignment(buster, task);
+        case task_t::type_t::STUN: // depends on current round through stun timeouts and cooldowns
+        case task_t::type_t::RADAR:
+            inputs.volatile_inputs = true;
+            break;
 
+        case task_t::type_t::EXPLORE:
         case task_t::type_t::RETURN:
-            return get_score_for_return_assignment(buster, task);
+            break;
         }
 
-        return 999999.0;
+        return inputs;
     }
 
-    factor_t get_score_for_bust_assignment(const buster_t& buster, const task_t& task)
+    // Candidate pairs are filtered before scoring, so that only pairs which can get a meaningful score are scored.
+    // Filters mirror early exits of scoring functions:
+    // - RETURN is meaningful only for carriers and COVER only for non-carriers,
+    // - STUN is not meaningful for enemy out of sight or stunned for long, for buster with stun on cooldown
+    //   (unless enemy is carrying ghost) and for enemy out of stun range (unless enemy is stunned or busting).
+    // RADAR tasks are never part of scored tasks (they are assigned as pending assignments only).
+    void prepare_candidate_filters()
     {
-        const ghost_t& ghost = game_data.ghosts.at(task.id);
-        count_t moves_needed = game_data.get_bust_moves_from_distance(distance_between(buster, ghost.position));
+        for (std::size_t b = 0; b < unassigned_busters.size(); ++b)
+        {
+            enemies_in_stun_range[b].reset();
+
+            for (id_type enemy_id : game_data.get_enemies_within_range(unassigned_busters[b], game_data.STUN_RANGE))
+                enemies_in_stun_range[b].set(enemy_id);
+        }
+    }
 
-        count_t ghost_stamina = std::min(ghost.stamina, static_cast<count_t>(30));
-        factor_t score = (ghost_stamina / (std::ceil((game_data.points + 0.1) / 4.0))) + (moves_needed * 4.0); // TODO: Experimental factor!
+    // Filter which removes pair of `b`-th unassigned buster and given task, if any
+    candidate_filter_t get_candidate_filter(std::size_t b, const task_t& task)
+    {
+        const buster_t& buster = unassigned_busters[b];
 
-        return score;
+        switch (task.type)
+        {
+        case task_t::type_t::RETURN:
+            return (buster.state != buster_t::state_t::CARRY_GHOST) ? candidate_filter_t::BUSTER_STATE : candidate_filter_t::NONE;
+
+        case task_t::type_t::COVER:
+            return (buster.state == buster_t::state_t::CARRY_GHOST) ? candidate_filter_t::BUSTER_STATE : candidate_filter_t::NONE;
+
+        case task_t::type_t::STUN:
+        {
+            if (game_data.enemies().count(task.id) == 0)
+                return candidate_filter_t::TARGET_STATE;
+
+            const buster_t enemy = game_data.enemies().at(task.id);
+
+            if (get_enemy_stunned_timeout(enemy) > params.stun_max_enemy_stunned_timeout)
+                return candidate_filter_t::TARGET_STATE;
+
+            if (enemy.state != buster_t::state_t::CARRY_GHOST && !can_stun_now(buster))
+                return candidate_filter_t::STUN_COOLDOWN;
+
+            if ((enemy.state == buster_t::state_t::NORMAL || enemy.state == buster_t::state_t::CARRY_GHOST) && !enemies_in_stun_range[b].test(enemy.id))
+                return candidate_filter_t::DISTANCE;
+
+            return candidate_filter_t::NONE;
+        }
+
+        default:
+            return candidate_filter_t::NONE;
+        }
     }
 
-    factor_t get_score_for_cover_assignment(const buster_t& buster, const task_t& task)
+    // Score which scoring function would give to pruned pair
+    factor_t get_pruned_score(const task_t& task) const
     {
-        if (buster.state == buster_t::state_t::CARRY_GHOST)
-            return 999999.0;
+        return (task.type == task_t::type_t::RETURN) ? 99999999.0 : 999999.0;
+    }
 
-        const buster_t& carrier = game_data.busters.at(task.id);
-        count_t moves_to_carrier = moves_from_distance(distance_between(buster, carrier));
-        count_t moves_to_base = moves_from_distance(distance_between(carrier, game_data.base_position.own));
+    // Scores all tasks of given type for all unassigned busters, rescoring only pairs invalidated since last round
+    void score_tasks_of_type(task_t::type_t type, scoring_function_t scoring_function)
+    {
+        for (task_registry_t::handle_t handle : tasks.get_handles_of_type(type))
+        {
+            const task_t& task = tasks.get(handle);
+            std::size_t column = tasks_handles.size();
 
-        factor_t score = moves_to_carrier * 15.0 + moves_to_base * 20.0;
+            tasks_handles.push_back(handle);
+            scores.update_task(handle, get_score_inputs_of_task(task, handle));
 
-        return score;
+            // Forbid stunning enemy multiple times at same round (won't stun in next either)
+            if (type == task_t::type_t::STUN)
+                solver.set_exclusive(column);
+
+            for (std::size_t b = 0; b < unassigned_busters.size(); ++b)
+            {
+                const buster_t& buster = unassigned_busters[b];
+                std::size_t buster_index = game_data.get_buster_index(buster.id);
+
+                candidate_filter_t filter = get_candidate_filter(b, task);
+                if (filter != candidate_filter_t::NONE)
+                {
+                    ++pruned_candidates_counts[static_cast<std::size_t>(filter)];
+                    profiler.count(counter_t::PRUNED_PAIRS, 1);
+                    solver.score(b, column) = get_pruned_score(task);
+                    continue;
+                }
+
+                ++scored_candidates_count;
+                profiler.count(counter_t::SCORED_PAIRS, 1);
+
+                factor_t score;
+                if (!scores.lookup(handle, buster_index, score))
+                {
+                    score = (this->*scoring_function)(buster, task);
+                    scores.store(handle, buster_index, score);
+                }
+                else if (VERIFY_SCORE_CACHE && score != (this->*scoring_function)(buster, task))
+                {
+                    throw std::logic_error("codebusters_player_t::score_tasks_of_type: cached score differs from recomputed one");
+                }
+
+                solver.score(b, column) = score;
+            }
+        }
     }
 
-    factor_t get_score_for_explore_assignment(const buster_t& buster, const task_t& task)
+    // Scores all EXPLORE tasks for all unassigned busters: `moves_to_explore * task.factor / end_of_game_factor`
+    // computed straight from struct-of-arrays positions and factors (not cached, recomputing is cheaper)
+    void score_explore_tasks()
     {
-        count_t moves_to_explore = moves_from_distance(distance_between(buster, task.position));
+        const std::vector<task_registry_t::handle_t>& handles = tasks.get_handles_of_type(task_t::type_t::EXPLORE);
+        if (handles.empty())
+            return;
+
+        std::size_t first_column = tasks_handles.size();
+        tasks_handles.insert(std::end(tasks_handles), std::begin(handles), std::end(handles));
+
+        // Forbid explorations where one buster is already going there (see conflicts in `assign_tasks`)
+        for (std::size_t column = first_column; column < tasks_handles.size(); ++column)
+            solver.set_exclusive(column);
+
+        scored_candidates_count += handles.size() * unassigned_busters.size();
+        profiler.count(counter_t::SCORED_PAIRS, handles.size() * unassigned_busters.size());
 
         factor_t ghosts_to_win = (game_data.ghosts_count / 2);
         ghosts_to_win -= game_data.points;
 
         factor_t end_of_game_factor = std::max(1.0, (5.0 - ghosts_to_win) / 2.0);
 
-        return (moves_to_explore * task.factor) / end_of_game_factor;
+        explore_squared_distances.resize(handles.size());
+
+        for (std::size_t b = 0; b < unassigned_busters.size(); ++b)
+        {
+            weighted_moves_from<static_cast<std::int64_t>(game_constants_t::MOVE_RANGE)>(
+                unassigned_busters[b].position,
+                tasks.get_explore_positions(),
+                tasks.get_explore_factors().data(),
+                end_of_game_factor,
+                explore_squared_distances.data(),
+                &solver.score(b, first_column));
+        }
+    }
+
+    factor_t get_score_for_bust_assignment(const buster_t& buster, const task_t& task)
+    {
+        const ghost_t& ghost = game_data.ghosts().at(task.id);
+        count_t moves_needed = game_data.get_bust_moves_from_squared_distance(squared_distance_between(buster.position, ghost.position));
+
+        factor_t ghost_stamina = std::min(static_cast<factor_t>(ghost.stamina), params.bust_stamina_cap);
+        factor_t score = (ghost_stamina / (std::ceil((game_data.points + 0.1) / params.bust_points_divisor))) + (moves_needed * params.bust_moves_weight);
+
+        return score;
+    }
+
+    factor_t get_score_for_cover_assignment(const buster_t& buster, const task_t& task)
+    {
+        if (buster.state == buster_t::state_t::CARRY_GHOST)
+            return 999999.0;
+
+        const buster_t& carrier = game_data.busters().at(task.id);
+        count_t moves_to_carrier = moves_from_squared_distance(squared_distance_between(buster.position, carrier.position));
+        count_t moves_to_base = moves_from_squared_distance(squared_distance_between(carrier.position, game_data.base_position.own));
+
+        factor_t score = moves_to_carrier * params.cover_moves_to_carrier_weight + moves_to_base * params.cover_moves_to_base_weight;
+
+        return score;
     }
 
     factor_t get_score_for_stun_assignment(const buster_t& buster, const task_t& task)
@@ -606,9 +1008,9 @@ private: // Scoring assignments
 
         try
         {
-            const buster_t& enemy = game_data.enemies.at(task.id);
+            const buster_t& enemy = game_data.enemies().at(task.id);
 
-            if (get_enemy_stunned_timeout(enemy) > 3)
+            if (get_enemy_stunned_timeout(enemy) > params.stun_max_enemy_stunned_timeout)
             {
                 // Don't bother to stun enemy who is already stunned and has long stun timeout
             }
@@ -618,15 +1020,15 @@ private: // Scoring assignments
             }
             else if (enemy.state == buster_t::state_t::CARRY_GHOST)
             {
-                count_t enemy_carrier_moves = moves_from_distance(
-                    distance_between(
-                    enemy,
+                count_t enemy_carrier_moves = moves_from_squared_distance(
+                    squared_distance_between(
+                    enemy.position,
                     game_data.get_position_in_range(
                     enemy.position,
                     game_data.base_position.enemy,
                     game_data.BASE_RELEASE_RANGE)));
                 count_t buster_moves_to_enemy_base =
-                    moves_from_distance(distance_between(buster,
+                    moves_from_squared_distance(squared_distance_between(buster.position,
                     game_data.get_position_in_range(buster.position,
                     game_data.base_position.enemy,
                     game_data.BASE_RELEASE_RANGE)));
@@ -634,24 +1036,24 @@ private: // Scoring assignments
                 if (get_stunned_timeout(buster) + 1 < enemy_carrier_moves &&
                     get_stun_cooldown(buster) + 1 < enemy_carrier_moves &&
                     buster_moves_to_enemy_base + 1 < enemy_carrier_moves &&
-                    moves_from_distance(distance_between(buster, enemy)) < 2)
+                    moves_from_squared_distance(squared_distance_between(buster.position, enemy.position)) < 2)
                 {
-                    score = 0.11;
+                    score = params.stun_carrier_score;
                 }
             }
             else if (enemy.state == buster_t::state_t::STUNNED)
             {
-                if (get_enemy_stunned_timeout(enemy) < 3 && can_stun_now(buster))
+                if (get_enemy_stunned_timeout(enemy) < params.restun_max_enemy_stunned_timeout && can_stun_now(buster))
                 {
-                    score = 0.13;
+                    score = params.restun_score;
                 }
             }
             else if (enemy.state == buster_t::state_t::BUSTING_GHOST)
             {
                 id_type ghost_id = static_cast<id_type>(enemy.value);
-                if (game_data.ghosts.at(ghost_id).stamina < 10 && can_stun_now(buster))
+                if (game_data.ghosts().at(ghost_id).stamina < params.stun_max_busted_ghost_stamina && can_stun_now(buster))
                 {
-                    score = 0.12;
+                    score = params.stun_busting_score;
                 }
             }
 
@@ -671,9 +1073,9 @@ private: // Scoring assignments
 
 
 private: // Compute tracking data methods
-    void compute_appeared_ghosts(const game_data_t& previous_game_data)
+    void compute_appeared_ghosts(const entities_t& previous_game_data)
     {
-        for (const auto& id_ghost_pair : game_data.ghosts)
+        for (const auto& id_ghost_pair : game_data.ghosts())
         {
             const ghost_t& ghost = id_ghost_pair.second;
 
@@ -691,21 +1093,21 @@ private: // Compute tracking data methods
         }
     }
 
-    void compute_disappeared_ghosts(const game_data_t& previous_game_data)
+    void compute_disappeared_ghosts(const entities_t& previous_game_data)
     {
         for (const auto& id_ghost_pair : previous_game_data.ghosts)
         {
             id_type ghost_id = id_ghost_pair.first;
 
-            if (game_data.ghosts.find(ghost_id) == game_data.ghosts.end())
+            if (game_data.ghosts().find(ghost_id) == game_data.ghosts().end())
                 on_disappeared_ghost(id_ghost_pair.second);
         }
     }
 
-    void compute_stun_tracking_data(const game_data_t& previous_game_data)
+    void compute_stun_tracking_data(const entities_t& previous_game_data)
     {
         // Finding out if any buster got stunned and if so, try to find out which stunned it
-        for (const auto& id_buster_pair : game_data.busters)
+        for (const auto& id_buster_pair : game_data.busters())
         {
             const buster_t& buster = id_buster_pair.second;
 
@@ -716,14 +1118,14 @@ private: // Compute tracking data methods
 
                 std::vector<id_type> enemies_close_by = game_data.get_enemies_within_range(buster, game_data.STUN_RANGE);
                 if (enemies_close_by.size() == 1)
-                    on_enemy_use_stun(game_data.enemies.at(enemies_close_by.front()));
+                    on_enemy_use_stun(game_data.enemies().at(enemies_close_by.front()));
             }
         }
     }
 
-    void compute_appeared_enemies(const game_data_t& previous_game_data)
+    void compute_appeared_enemies(const entities_t& previous_game_data)
     {
-        for (const auto& id_enemy_pair : game_data.enemies)
+        for (const auto& id_enemy_pair : game_data.enemies())
         {
             const buster_t& enemy = id_enemy_pair.second;
 
@@ -732,53 +1134,53 @@ private: // Compute tracking data methods
         }
     }
 
-    void compute_disappeared_enemies(const game_data_t& previous_game_data)
+    void compute_disappeared_enemies(const entities_t& previous_game_data)
     {
         for (const auto& id_enemy_pair : previous_game_data.enemies)
         {
             const buster_t& enemy = id_enemy_pair.second;
 
-            if (game_data.enemies.find(enemy.id) == game_data.enemies.end())
+            if (game_data.enemies().find(enemy.id) == game_data.enemies().end())
                 on_disappeared_enemy(enemy);
         }
     }
 
-    void compute_busters_start_carrying_ghosts(const game_data_t& previous_game_data)
+    void compute_busters_start_carrying_ghosts(const entities_t& previous_game_data)
     {
-        for (const auto& id_buster_pair : game_data.busters)
+        for (const auto& id_buster_pair : game_data.busters())
         {
             const buster_t& buster = id_buster_pair.second;
 
             if (previous_game_data.busters.at(buster.id).state != buster_t::state_t::CARRY_GHOST
-                && game_data.busters.at(buster.id).state == buster_t::state_t::CARRY_GHOST)
+                && game_data.busters().at(buster.id).state == buster_t::state_t::CARRY_GHOST)
             {
                 on_start_carrying_ghost(buster);
             }
         }
     }
 
-    void compute_busters_stop_carrying_ghosts(const game_data_t& previous_game_data)
+    void compute_busters_stop_carrying_ghosts(const entities_t& previous_game_data)
     {
-        for (const auto& id_buster_pair : game_data.busters)
+        for (const auto& id_buster_pair : game_data.busters())
         {
             const buster_t& buster = id_buster_pair.second;
 
             if (previous_game_data.busters.at(buster.id).state == buster_t::state_t::CARRY_GHOST
-                && game_data.busters.at(buster.id).state != buster_t::state_t::CARRY_GHOST)
+                && game_data.busters().at(buster.id).state != buster_t::state_t::CARRY_GHOST)
             {
                 on_stop_carrying_ghost(buster);
             }
         }
     }
 
-    void compute_lost_ghosts(const game_data_t& previous_game_data)
+    void compute_lost_ghosts(const entities_t& previous_game_data)
     {
-        for (const auto& id_buster_pair : game_data.busters)
+        for (const auto& id_buster_pair : game_data.busters())
         {
             const buster_t& buster = id_buster_pair.second;
 
             if (previous_game_data.busters.at(buster.id).state == buster_t::state_t::CARRY_GHOST
-                && game_data.busters.at(buster.id).state == buster_t::state_t::STUNNED)
+                && game_data.busters().at(buster.id).state == buster_t::state_t::STUNNED)
             {
                 on_lose_ghost(buster);
             }
@@ -794,7 +1196,7 @@ private: // Tracking callback methods
             tracking_data.ghosts_projected.push_back(game_data.get_inverted_position(ghost.position));
 
             // Create explore (projected) task
-            tasks.push_back(task_t::make_explore(game_data.get_inverted_position(ghost.position), projected_ghost_factor));
+            add_task(task_t::make_explore(game_data.get_inverted_position(ghost.position), params.projected_ghost_factor));
         }
     }
 
@@ -803,10 +1205,10 @@ private: // Tracking callback methods
         tracking_data.ghosts_out_of_scope.erase(ghost.id);
 
         // Create bust task
-        tasks.push_back(task_t::make_bust(ghost.id));
+        add_task(task_t::make_bust(ghost.id));
 
         // Delete explore (out-of-scope) task
-        delete_tasks(task_t::type_t::EXPLORE, ghost.position);
+        delete_explore_tasks(ghost.position);
     }
 
     void on_disappeared_ghost(const ghost_t& ghost)
@@ -815,12 +1217,12 @@ private: // Tracking callback methods
 
         factor_t stamina_factor = 1.0;
         if (ghost.stamina < 5)
-            stamina_factor = 0.7;
+            stamina_factor = params.weak_out_of_scope_ghost_multiplier;
         else if (ghost.stamina < 16)
-            stamina_factor = 0.9;
+            stamina_factor = params.medium_out_of_scope_ghost_multiplier;
 
         // Create explore (out-of-scope) task
-        tasks.push_back(task_t::make_explore(ghost.position, out_of_scope_ghost_factor * stamina_factor));
+        add_task(task_t::make_explore(ghost.position, params.out_of_scope_ghost_factor * stamina_factor));
 
         // Delete bust task
         delete_tasks(task_t::type_t::BUST, ghost.id);
@@ -829,7 +1231,7 @@ private: // Tracking callback methods
     void on_reappeared_enemy(const buster_t& enemy)
     {
         // Create stun task
-        tasks.push_back(task_t::make_stun(enemy.id));
+        add_task(task_t::make_stun(enemy.id));
     }
 
     void on_disappeared_enemy(const buster_t& enemy)
@@ -851,7 +1253,7 @@ private: // Tracking callback methods
     void on_start_carrying_ghost(const buster_t& buster)
     {
         // Create cover task
-        tasks.push_back(task_t::make_cover(buster.id));
+        add_task(task_t::make_cover(buster.id));
     }
 
     void on_stop_carrying_ghost(const buster_t& buster)
@@ -862,13 +1264,16 @@ private: // Tracking callback methods
 
     void on_new_round()
     {
-        for (const auto& id_buster_pair : game_data.busters)
+        for (const auto& id_buster_pair : game_data.busters())
         {
             const buster_t& buster = id_buster_pair.second;
 
-            delete_tasks(task_t::type_t::EXPLORE, buster.position, game_data.MOVE_RANGE / 2.0);
+            delete_explore_tasks(buster.position, game_data.MOVE_RANGE / 2.0);
         }
 
+        if (game_data.round > explore_task_max_age)
+            tasks.erase_explore_older_than(game_data.round - explore_task_max_age);
+
         if (get_tasks_count_of_type(task_t::type_t::EXPLORE) < game_data.busters_count)
         {
             insert_random_explore_tasks(game_data.busters_count * 3);
@@ -895,17 +1300,17 @@ private: // Tracking utility methods
 
     bool can_stun_enemy_now(const buster_t& buster, const buster_t& enemy)
     {
-        return (can_stun_now(buster) && distance_between(buster, enemy) <= game_data.STUN_RANGE);
+        return (can_stun_now(buster) && is_within_range(buster.position, enemy.position, game_data.STUN_RANGE));
     }
 
     count_t get_stun_cooldown(const buster_t& buster)
     {
         long long int result = 0;
 
-        auto stun_usage = tracking_data.buster_stun_usage.find(buster.id);
-        if (stun_usage != tracking_data.buster_stun_usage.end())
+        round_num_t stun_usage = tracking_data.buster_stun_usage[buster.id];
+        if (stun_usage != NEVER_ROUND)
         {
-            result += (*stun_usage).second;
+            result += stun_usage;
             result += game_data.STUN_COOLDOWN;
             result -= game_data.round;
         }
@@ -917,10 +1322,10 @@ private: // Tracking utility methods
     {
         long long int result = 0;
 
-        auto stun_usage = tracking_data.enemy_stun_usage.find(enemy.id);
-        if (stun_usage != tracking_data.enemy_stun_usage.end())
+        round_num_t stun_usage = tracking_data.enemy_stun_usage[enemy.id];
+        if (stun_usage != NEVER_ROUND)
         {
-            result += (*stun_usage).second;
+            result += stun_usage;
             result += game_data.STUN_COOLDOWN;
             result -= game_data.round;
         }
@@ -934,10 +1339,10 @@ private: // Tracking utility methods
             return 0u;
 
         long long int result = 0;
-        auto stunned_since = tracking_data.buster_stunned_since.find(buster.id);
-        if (stunned_since != tracking_data.buster_stunned_since.end())
+        round_num_t stunned_since = tracking_data.buster_stunned_since[buster.id];
+        if (stunned_since != NEVER_ROUND)
         {
-            result += (*stunned_since).second;
+            result += stunned_since;
             result += game_data.STUN_TIMEOUT;
             result -= game_data.round;
         }
@@ -951,10 +1356,10 @@ private: // Tracking utility methods
             return 0u;
 
         long long int result = 0;
-        auto stunned_since = tracking_data.enemy_stunned_since.find(enemy.id);
-        if (stunned_since != tracking_data.enemy_stunned_since.end())
+        round_num_t stunned_since = tracking_data.enemy_stunned_since[enemy.id];
+        if (stunned_since != NEVER_ROUND)
         {
-            result += (*stunned_since).second;
+            result += stunned_since;
             result += game_data.STUN_TIMEOUT;
             result -= game_data.round;
         }
@@ -975,16 +1380,68 @@ private: // Tracking utility methods
 
 
 private:
-    game_data_t game_data; // all game data recieved as input
-    tracking_data_t tracking_data; // all crurrently tracked data
-    std::vector<task_t> tasks; // all currently available tasks
-    std::map<id_type, assignment_t> assignments; // assignments in current round
-    std::map<id_type, assignment_t> pending_assignments; // assignments for curent round from last round (continuations)
-    std::set<id_type> initial_assignments_done; // who already done it's initial assignment (radar explore)
+    game_data_t<BUSTERS_COUNT> game_data; // all game data recieved as input
+    const strategy_params_t params; // tunable factors and thresholds of scoring
+    tracking_data_t<BUSTERS_COUNT> tracking_data; // all crurrently tracked data
+    task_registry_t tasks; // all currently available tasks
+    score_cache_t<BUSTERS_COUNT> scores; // scores of (task, buster) pairs from previous rounds
+    assignment_solver_t solver; // chooses assignments from scores of all (buster, task) pairs
+    std::vector<buster_t> unassigned_busters; // scratch buffers for `assign_tasks`
+    std::vector<task_registry_t::handle_t> tasks_handles;
+    std::vector<std::int32_t> explore_squared_distances; // by EXPLORE task, for one buster at a time
+    std::array<std::bitset<2 * BUSTERS_COUNT>, BUSTERS_COUNT> enemies_in_stun_range; // by unassigned buster, bit per enemy id
+    std::array<std::size_t, CANDIDATE_FILTERS_COUNT> pruned_candidates_counts; // by filter, over whole game
+    std::size_t scored_candidates_count;
+    per_buster_t<assignment_t, BUSTERS_COUNT> assignments; // assignments in current round
+    per_buster_t<assignment_t, BUSTERS_COUNT> pending_assignments; // assignments for curent round from last round (continuations)
+    std::bitset<BUSTERS_COUNT> initial_assignments_done; // who already done it's initial assignment (radar explore), by buster index
+    std::array<std::string, 2 * BUSTERS_COUNT> buster_messages; // preformatted command messages indexed by buster id
+    std::array<command_t, BUSTERS_COUNT> commands; // commands of current round indexed by buster index
+    output_buffer_t output; // commands of current round, written once per round
+    std::mt19937 random_engine; // seeded explicitly so that recorded games can be replayed deterministically
+    deadline_t round_deadline;
+    phase_profiler_t profiler; // per-phase latencies and counters, compiled in with `PROFILE_PHASES`
+    per_buster_t<assignment_t, BUSTERS_COUNT> previous_assignments; // assignments from last round (cheap path when out of time)
+    const bool use_watchdog; // only when commands are written anywhere
+    std::array<command_t, BUSTERS_COUNT> fallback_commands; // written by watchdog instead of `commands` when out of time
+    output_buffer_t fallback_output;
+    watchdog_t watchdog; // last member, so that its thread stops before anything it uses is destroyed
 
 
 private:
-    const factor_t out_of_scope_ghost_factor = 12.0;
-    const factor_t projected_ghost_factor = 18.0;
-    const factor_t explore_factor = 50.0; // explore should be expensive since we should get most data from initial radar move
+    static const bool REPORT_STATISTICS = false; // `true` writes task pool and candidates statistics to stderr after the game
+    static const bool VERIFY_SCORE_CACHE = false; // `true` checks every cached score against recomputed one
+    static constexpr double explore_merge_distance = game_constants_t::MOVE_RANGE / 2.0; // closer EXPLORE tasks are merged
+    static const round_num_t explore_task_max_age = 60; // EXPLORE tasks not refreshed for that many rounds are dropped
+
+    static const bool USE_WATCHDOG = true; // `false` disables writing fallback commands when round runs out of time
+
+    std::chrono::microseconds round_time_budget { 85000 }; // game allows 100 ms per round, rest is safety margin
+    const std::chrono::microseconds scoring_time_reserve { 15000 }; // less time left skips scoring and reuses last assignments
+    const std::chrono::microseconds execution_time_reserve { 5000 }; // time left for executing and writing commands after solver
+    const std::chrono::microseconds assignment_time_budget { 5000 }; // optimal solver falls back to greedy beyond it
 };
+
+
+// Runs game with player specialized for number of busters per player given in game's settings
+void play_codebusters(const game_settings_t& settings, unsigned int random_seed, int output_fd,
+    const strategy_params_t& params = strategy_params_t())
+{
+    switch (settings.busters_count)
+    {
+    case 2:
+        codebusters_player_t<2>(settings, random_seed, output_fd, params).play();
+        break;
+    case 3:
+        codebusters_player_t<3>(settings, random_seed, output_fd, params).play();
+        break;
+    case 4:
+        codebusters_player_t<4>(settings, random_seed, output_fd, params).play();
+        break;
+    case 5:
+        codebusters_player_t<5>(settings, random_seed, output_fd, params).play();
+        break;
+    default:
+        throw std::out_of_range("Unsupported number of busters per player");
+    }
+}
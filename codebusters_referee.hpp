@@ -0,0 +1,587 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "codebusters_player.hpp"
+#include "command.hpp"
+#include "constants.hpp"
+#include "entity.hpp"
+#include "game_data.hpp"
+#include "input.hpp"
+#include "input_reader.hpp"
+#include "output_buffer.hpp"
+#include "strategy_params.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+
+// Headless referee: keeps whole (not fogged) game state and applies commands of both teams by game's rules.
+//
+// Round is resolved in the following order:
+// - stun cooldowns count down, stunned busters ignore their commands and count down their stun,
+// - all STUN commands are applied at once, stunned buster drops carried ghost and ignores its command,
+// - MOVE, BUST, RELEASE, EJECT and RADAR commands are applied, invalid ones leave buster idle,
+// - every ghost loses one stamina per buster busting it, ghost without stamina is caught by the team with more
+//   busters busting it (by nobody on tie),
+// - ghosts which aren't busted (nor dropped this round) flee from the closest buster(s) seen at round's start.
+//
+// Every team sees all of its busters and enemies and ghosts within vision range of any of them (radar range
+// in the round after radar was used). Busters of team 0 have ids [0, BUSTERS_COUNT), of team 1
+// [BUSTERS_COUNT, 2 * BUSTERS_COUNT). Ghosts are placed from given seed symmetrically (ghost 0 in the middle
+// for odd count, the rest in mirrored pairs), so that the same seed always gives the same game.
+
+template <count_t BUSTERS_COUNT>
+class codebusters_referee_t : public game_constants_t
+{
+public:
+    using commands_t = std::array<command_t, BUSTERS_COUNT>;
+
+    static const count_t TEAMS_COUNT = 2;
+
+
+public:
+    codebusters_referee_t(count_t ghosts_count, unsigned int random_seed)
+        : ghosts_count(ghosts_count), round(0), random_engine(random_seed), stun_cooldowns(), radar_used(), radar_active(), ghosts_on_map()
+    {
+        if (ghosts_count > MAX_GHOSTS_COUNT)
+            throw std::out_of_range("Unsupported number of ghosts");
+
+        points.fill(0);
+
+        place_busters();
+        place_ghosts();
+
+        for (unsigned int& seed : players_seeds)
+            seed = static_cast<unsigned int>(random_engine());
+    }
+
+    game_settings_t get_game_settings(id_type team_id) const
+    {
+        return game_settings_t { team_id, BUSTERS_COUNT, ghosts_count };
+    }
+
+    // Random seed for player of given team, derived from game's seed
+    unsigned int get_player_seed(id_type team_id) const
+    {
+        return players_seeds[team_id];
+    }
+
+    // Writes round's input as seen by given team, in game's text protocol
+    void write_round_data(id_type team_id, output_buffer_t& output) const
+    {
+        std::bitset<2 * BUSTERS_COUNT> visible_busters;
+        std::bitset<MAX_GHOSTS_COUNT> visible_ghosts;
+
+        for (id_type id = team_id * BUSTERS_COUNT; id < (team_id + 1) * BUSTERS_COUNT; ++id)
+        {
+            const position_t& position = busters[id].position;
+            const double range = radar_active.test(id) ? RADAR_VISION_RANGE : VISION_RANGE;
+
+            visible_busters.set(id);
+
+            for (id_type other = 0; other < 2 * BUSTERS_COUNT; ++other)
+            {
+                if (is_within_range(position, busters[other].position, range))
+                    visible_busters.set(other);
+            }
+
+            for (id_type ghost = 0; ghost < ghosts_count; ++ghost)
+            {
+                if (ghosts_on_map.test(ghost) && is_within_range(position, ghosts[ghost].position, range))
+                    visible_ghosts.set(ghost);
+            }
+        }
+
+        output << (visible_busters.count() + visible_ghosts.count()) << '\n';
+
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            if (!visible_busters.test(id))
+                continue;
+
+            const buster_t& buster = busters[id];
+            output << id << ' ' << buster.position << ' ' << get_team(id) << ' ' << static_cast<int>(buster.state) << ' ' << buster.value << '\n';
+        }
+
+        for (id_type id = 0; id < ghosts_count; ++id)
+        {
+            if (!visible_ghosts.test(id))
+                continue;
+
+            const ghost_t& ghost = ghosts[id];
+            output << id << ' ' << ghost.position << ' ' << -1 << ' ' << ghost.stamina << ' ' << ghost.busters_catching << '\n';
+        }
+    }
+
+    // Resolves one round from commands of both teams (indexed by buster index within team)
+    void play_round(const commands_t& commands_of_team_0, const commands_t& commands_of_team_1)
+    {
+        std::array<command_t, 2 * BUSTERS_COUNT> commands;
+        std::copy(std::begin(commands_of_team_0), std::end(commands_of_team_0), std::begin(commands));
+        std::copy(std::begin(commands_of_team_1), std::end(commands_of_team_1), std::begin(commands) + BUSTERS_COUNT);
+
+        std::array<position_t, 2 * BUSTERS_COUNT> start_positions;
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+            start_positions[id] = busters[id].position;
+
+        std::bitset<2 * BUSTERS_COUNT> acting = update_stuns();
+        radar_active.reset();
+        dropped_ghosts.reset();
+
+        for (id_type ghost_id = 0; ghost_id < ghosts_count; ++ghost_id)
+            ghosts[ghost_id].busters_catching = 0;
+
+        apply_stun_commands(commands, acting);
+
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            if (acting.test(id))
+                apply_command(id, commands[id]);
+        }
+
+        resolve_busting();
+        move_fleeing_ghosts(start_positions);
+
+        ++round;
+    }
+
+    bool is_game_over() const
+    {
+        return (round >= ROUND_COUNT || points[0] + points[1] == ghosts_count);
+    }
+
+    count_t get_points(id_type team_id) const
+    {
+        return points[team_id];
+    }
+
+    round_num_t get_round() const
+    {
+        return round;
+    }
+
+
+private: // Round resolution
+    // Counts down stun cooldowns and stuns, returns busters which act this round
+    std::bitset<2 * BUSTERS_COUNT> update_stuns()
+    {
+        std::bitset<2 * BUSTERS_COUNT> acting;
+
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            buster_t& buster = busters[id];
+
+            if (stun_cooldowns[id] > 0)
+                --stun_cooldowns[id];
+
+            if (buster.state != buster_t::state_t::STUNNED)
+            {
+                acting.set(id);
+                continue;
+            }
+
+            if (--buster.value == 0)
+                set_idle(buster);
+        }
+
+        return acting;
+    }
+
+    // All stuns happen at once, so busters stunning each other are both stunned
+    void apply_stun_commands(const std::array<command_t, 2 * BUSTERS_COUNT>& commands, std::bitset<2 * BUSTERS_COUNT>& acting)
+    {
+        std::bitset<2 * BUSTERS_COUNT> stunned;
+
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            const command_t& command = commands[id];
+            if (!acting.test(id) || command.type != command_t::type_t::STUN)
+                continue;
+
+            acting.reset(id);
+
+            if (stun_cooldowns[id] > 0 || command.target_id >= 2 * BUSTERS_COUNT || command.target_id == id ||
+                !is_within_range(busters[id].position, busters[command.target_id].position, STUN_RANGE))
+            {
+                if (busters[id].state != buster_t::state_t::CARRY_GHOST)
+                    set_idle(busters[id]);
+                continue;
+            }
+
+            stunned.set(command.target_id);
+            stun_cooldowns[id] = STUN_COOLDOWN;
+
+            if (busters[id].state != buster_t::state_t::CARRY_GHOST)
+                set_idle(busters[id]);
+        }
+
+        for (id_type id = 0; id < 2 * BUSTERS_COUNT; ++id)
+        {
+            if (!stunned.test(id))
+                continue;
+
+            buster_t& buster = busters[id];
+            if (buster.state == buster_t::state_t::CARRY_GHOST)
+                drop_ghost(buster, buster.position);
+
+            buster.state = buster_t::state_t::STUNNED;
+            buster.value = static_cast<value_t>(STUN_TIMEOUT - 1); // rounds until buster acts again
+            acting.reset(id);
+        }
+    }
+
+    void apply_command(id_type id, const command_t& command)
+    {
+        buster_t& buster = busters[id];
+        const bool carrying = (buster.state == buster_t::state_t::CARRY_GHOST);
+
+        switch (command.type)
+        {
+        case command_t::type_t::MOVE:
+            buster.position = get_position_towards(buster.position, command.position, MOVE_RANGE);
+            break;
+
+        case command_t::type_t::BUST:
+            if (!carrying && command.target_id < ghosts_count && ghosts_on_map.test(command.target_id))
+            {
+                ghost_t& ghost = ghosts[command.target_id];
+                std::int64_t squared_distance = squared_distance_between(buster.position, ghost.position);
+
+                if (squared_range(BUST_RANGE_MIN) <= squared_distance && squared_distance <= squared_range(BUST_RANGE_MAX))
+                {
+                    buster.state = buster_t::state_t::BUSTING_GHOST;
+                    buster.value = static_cast<value_t>(ghost.id);
+                    ++ghost.busters_catching;
+                    return;
+                }
+            }
+            break;
+
+        case command_t::type_t::RELEASE:
+            if (carrying)
+            {
+                if (is_within_range(buster.position, base_position_t(get_team(id)).own, BASE_RELEASE_RANGE))
+                {
+                    ++points[get_team(id)];
+                    set_idle(buster);
+                }
+                else
+                {
+                    drop_ghost(buster, buster.position);
+                }
+            }
+            break;
+
+        case command_t::type_t::EJECT:
+            if (carrying)
+                drop_ghost(buster, get_position_towards(buster.position, command.position, EJECT_RANGE));
+            break;
+
+        case command_t::type_t::RADAR:
+            if (!radar_used.test(id))
+            {
+                radar_used.set(id);
+                radar_active.set(id);
+            }
+            break;
+
+        case command_t::type_t::STUN:
+            break; // already applied
+        }
+
+        if (buster.state != buster_t::state_t::CARRY_GHOST)
+            set_idle(buster);
+    }
+
+    // Every busted ghost loses stamina, ghost without stamina goes to the lowest id buster of the team with more
+    // busters busting it
+    void resolve_busting()
+    {
+        for (id_type ghost_id = 0; ghost_id < ghosts_count; ++ghost_id)
+        {
+            ghost_t& ghost = ghosts[ghost_id];
+            if (!ghosts_on_map.test(ghost_id) || ghost.busters_catching == 0)
+                continue;
+
+            ghost.stamina -= std::min(ghost.stamina, ghost.busters_catching);
+            if (ghost.stamina > 0)
+                continue;
+
+            std::array<count_t, TEAMS_COUNT> catching {};
+            std::array<id_type, TEAMS_COUNT> catchers;
+            catchers.fill(2 * BUSTERS_COUNT);
+
+            for (id_type id = 2 * BUSTERS_COUNT; id-- > 0;)
+            {
+                const buster_t& buster = busters[id];
+                if (buster.state == buster_t::state_t::BUSTING_GHOST && buster.value == static_cast<value_t>(ghost_id))
+                {
+                    ++catching[get_team(id)];
+                    catchers[get_team(id)] = id;
+                }
+            }
+
+            if (catching[0] == catching[1])
+                continue;
+
+            // Other busters busting caught ghost are left idle
+            for (buster_t& buster : busters)
+            {
+                if (buster.state == buster_t::state_t::BUSTING_GHOST && buster.value == static_cast<value_t>(ghost_id))
+                    set_idle(buster);
+            }
+
+            buster_t& catcher = busters[catchers[(catching[0] > catching[1]) ? 0 : 1]];
+            catcher.state = buster_t::state_t::CARRY_GHOST;
+            catcher.value = static_cast<value_t>(ghost_id);
+
+            ghosts_on_map.reset(ghost_id);
+        }
+    }
+
+    // Ghosts move away from the closest buster (from average position of all equally close ones) within vision range
+    void move_fleeing_ghosts(const std::array<position_t, 2 * BUSTERS_COUNT>& start_positions)
+    {
+        for (id_type ghost_id = 0; ghost_id < ghosts_count; ++ghost_id)
+        {
+            ghost_t& ghost = ghosts[ghost_id];
+            if (!ghosts_on_map.test(ghost_id) || ghost.busters_catching > 0 || dropped_ghosts.test(ghost_id))
+                continue;
+
+            std::int64_t closest = static_cast<std::int64_t>(squared_range(VISION_RANGE)) + 1;
+            double sum_x = 0.0, sum_y = 0.0;
+            count_t closest_count = 0;
+
+            for (const position_t& position : start_positions)
+            {
+                std::int64_t squared_distance = squared_distance_between(ghost.position, position);
+                if (squared_distance > closest)
+                    continue;
+
+                if (squared_distance < closest)
+                {
+                    closest = squared_distance;
+                    sum_x = sum_y = 0.0;
+                    closest_count = 0;
+                }
+
+                sum_x += static_cast<double>(position.x);
+                sum_y += static_cast<double>(position.y);
+                ++closest_count;
+            }
+
+            if (closest_count == 0)
+                continue;
+
+            const double from_x = sum_x / closest_count;
+            const double from_y = sum_y / closest_count;
+            const double dx = static_cast<double>(ghost.position.x) - from_x;
+            const double dy = static_cast<double>(ghost.position.y) - from_y;
+            const double distance = std::sqrt(dx*dx + dy*dy);
+
+            if (distance > 0.0)
+            {
+                ghost.position = game_data_t<BUSTERS_COUNT>::get_clamped_position(
+                    std::round(ghost.position.x + dx / distance * GHOST_MOVE_RANGE),
+                    std::round(ghost.position.y + dy / distance * GHOST_MOVE_RANGE));
+            }
+        }
+    }
+
+
+private: // Utility methods
+    void place_busters()
+    {
+        // Spread along a line across the diagonal, at base release range from team's base
+        const double spacing = 600.0;
+        const double center = BASE_RELEASE_RANGE / std::sqrt(2.0);
+
+        for (id_type i = 0; i < BUSTERS_COUNT; ++i)
+        {
+            double offset = (static_cast<double>(i) - (BUSTERS_COUNT - 1) / 2.0) * spacing / std::sqrt(2.0);
+            position_t position = game_data_t<BUSTERS_COUNT>::get_clamped_position(std::round(center + offset), std::round(center - offset));
+
+            busters[i].id = i;
+            busters[i].position = position;
+            set_idle(busters[i]);
+
+            busters[BUSTERS_COUNT + i].id = BUSTERS_COUNT + i;
+            busters[BUSTERS_COUNT + i].position = get_mirrored_position(position);
+            set_idle(busters[BUSTERS_COUNT + i]);
+        }
+    }
+
+    void place_ghosts()
+    {
+        static const count_t STAMINAS[] = { 3, 15, 40 };
+
+        std::uniform_int_distribution<coord_t> random_x(0, map_size.x - 1);
+        std::uniform_int_distribution<coord_t> random_y(0, map_size.y - 1);
+        std::uniform_int_distribution<std::size_t> random_stamina(0, 2);
+
+        id_type id = 0;
+        if (ghosts_count % 2 == 1)
+            place_ghost(id++, { (map_size.x - 1) / 2, (map_size.y - 1) / 2 }, STAMINAS[random_stamina(random_engine)]);
+
+        while (id < ghosts_count)
+        {
+            // Ghosts don't start within vision range of any base
+            position_t position;
+            do
+            {
+                position = { random_x(random_engine), random_y(random_engine) };
+            }
+            while (is_within_range(position, base_position_t(0).own, VISION_RANGE) ||
+                is_within_range(position, base_position_t(1).own, VISION_RANGE));
+
+            count_t stamina = STAMINAS[random_stamina(random_engine)];
+            place_ghost(id++, position, stamina);
+
+            if (id < ghosts_count)
+                place_ghost(id++, get_mirrored_position(position), stamina);
+        }
+    }
+
+    void place_ghost(id_type id, position_t position, count_t stamina)
+    {
+        ghosts[id].id = id;
+        ghosts[id].position = position;
+        ghosts[id].stamina = stamina;
+        ghosts[id].busters_catching = 0;
+
+        ghosts_on_map.set(id);
+    }
+
+    void drop_ghost(buster_t& carrier, position_t position)
+    {
+        id_type ghost_id = static_cast<id_type>(carrier.value);
+
+        ghosts[ghost_id].position = position;
+        ghosts_on_map.set(ghost_id);
+        dropped_ghosts.set(ghost_id);
+
+        set_idle(carrier);
+    }
+
+    static void set_idle(buster_t& buster)
+    {
+        buster.state = buster_t::state_t::NORMAL;
+        buster.value = -1;
+    }
+
+    static position_t get_position_towards(const position_t& from, const position_t& to, double range)
+    {
+        if (is_within_range(from, to, range))
+            return game_data_t<BUSTERS_COUNT>::get_clamped_position(static_cast<double>(to.x), static_cast<double>(to.y));
+
+        const double dx = static_cast<double>(to.x) - static_cast<double>(from.x);
+        const double dy = static_cast<double>(to.y) - static_cast<double>(from.y);
+        const double factor = range / std::sqrt(dx*dx + dy*dy);
+
+        return game_data_t<BUSTERS_COUNT>::get_clamped_position(std::round(from.x + dx * factor), std::round(from.y + dy * factor));
+    }
+
+    static position_t get_mirrored_position(const position_t& position)
+    {
+        return { map_size.x - position.x - 1, map_size.y - position.y - 1 };
+    }
+
+    static id_type get_team(id_type buster_id)
+    {
+        return buster_id / BUSTERS_COUNT;
+    }
+
+
+private:
+    const count_t ghosts_count;
+    round_num_t round;
+    std::mt19937 random_engine; // only used to set up the game
+    std::array<unsigned int, TEAMS_COUNT> players_seeds;
+    std::array<count_t, TEAMS_COUNT> points;
+
+    std::array<buster_t, 2 * BUSTERS_COUNT> busters; // indexed by id
+    std::array<count_t, 2 * BUSTERS_COUNT> stun_cooldowns; // rounds until buster can stun again
+    std::bitset<2 * BUSTERS_COUNT> radar_used;
+    std::bitset<2 * BUSTERS_COUNT> radar_active; // radar used in last round, vision is extended in current input
+
+    std::array<ghost_t, MAX_GHOSTS_COUNT> ghosts; // indexed by id, position of carried ghost is updated when dropped
+    std::bitset<MAX_GHOSTS_COUNT> ghosts_on_map; // neither carried nor scored
+    std::bitset<MAX_GHOSTS_COUNT> dropped_ghosts; // dropped in current round, they don't flee
+};
+
+template <count_t BUSTERS_COUNT>
+const count_t codebusters_referee_t<BUSTERS_COUNT>::TEAMS_COUNT;
+
+
+struct match_result_t
+{
+    std::array<count_t, 2> points; // by team
+    round_num_t rounds;
+};
+
+
+// Plays whole game of two bots (with given strategy parameters) against each other in-process, bots get their input
+// from memory and their commands are read back directly. The same seed always gives the same game, as long as bots
+// finish rounds within their time budget (otherwise they drop to cheaper paths).
+template <count_t BUSTERS_COUNT>
+match_result_t play_codebusters_match(count_t ghosts_count, unsigned int random_seed, const strategy_params_t& params_0, const strategy_params_t& params_1)
+{
+    codebusters_referee_t<BUSTERS_COUNT> referee(ghosts_count, random_seed);
+
+    codebusters_player_t<BUSTERS_COUNT> player_0(referee.get_game_settings(0), referee.get_player_seed(0), -1, params_0);
+    codebusters_player_t<BUSTERS_COUNT> player_1(referee.get_game_settings(1), referee.get_player_seed(1), -1, params_1);
+    codebusters_player_t<BUSTERS_COUNT>* players[] = { &player_0, &player_1 };
+
+    output_buffer_t round_data(-1);
+
+    for (auto player : players)
+        player->start_game();
+
+    while (!referee.is_game_over())
+    {
+        for (id_type team_id = 0; team_id < 2; ++team_id)
+        {
+            round_data.clear();
+            referee.write_round_data(team_id, round_data);
+
+            input_reader_t reader(round_data.data(), round_data.size());
+            input::use_reader(reader);
+            players[team_id]->play_round();
+        }
+
+        referee.play_round(player_0.get_commands(), player_1.get_commands());
+    }
+
+    input::use_default_reader();
+
+    for (auto player : players)
+        player->finish_game();
+
+    return match_result_t { { { referee.get_points(0), referee.get_points(1) } }, referee.get_round() };
+}
+
+// Plays match with number of busters per player known only at runtime
+match_result_t play_codebusters_match(count_t busters_count, count_t ghosts_count, unsigned int random_seed,
+    const strategy_params_t& params_0 = strategy_params_t(), const strategy_params_t& params_1 = strategy_params_t())
+{
+    switch (busters_count)
+    {
+    case 2:
+        return play_codebusters_match<2>(ghosts_count, random_seed, params_0, params_1);
+    case 3:
+        return play_codebusters_match<3>(ghosts_count, random_seed, params_0, params_1);
+    case 4:
+        return play_codebusters_match<4>(ghosts_count, random_seed, params_0, params_1);
+    case 5:
+        return play_codebusters_match<5>(ghosts_count, random_seed, params_0, params_1);
+    default:
+        throw std::out_of_range("Unsupported number of busters per player");
+    }
+}
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "output_buffer.hpp"
 #include "types.hpp"
 
 
+// Command is a plain, trivially-copyable value describing what given buster does this round.
+// Formatting to game's text protocol is done by table dispatch on command's type.
+
 class command_t
 {
 public:
@@ -16,132 +25,115 @@ public:
         STUN,
     };
 
+    static const std::size_t TYPES_COUNT = 6;
 
-public:
-    command_t(type_t type, id_type owner_id)
-        : type(type), owner_id(owner_id)
+    struct eject_params_t
     {
-    }
-
-    virtual ~command_t() = default;
-    virtual void execute(const std::string& message) const = 0;
-
+        position_t position;
+        id_type buster_id;
+    };
 
-public:
     type_t type;
     id_type owner_id;
-};
+    id_type target_id; // for: bust (ghost), stun (enemy)
+    position_t position; // for: move, eject
 
 
-class move_command_t : public command_t
-{
 public:
-    move_command_t(id_type owner_id, position_t position)
-        : command_t(type_t::MOVE, owner_id), position(position)
+    static command_t make_move(id_type owner_id, position_t position)
     {
+        return command_t { type_t::MOVE, owner_id, 0, position };
     }
 
-    void execute(const std::string& message) const override
+    static command_t make_bust(id_type owner_id, id_type ghost_id)
     {
-        std::cout << "MOVE " << position << " " << message << std::endl;
+        return command_t { type_t::BUST, owner_id, ghost_id, {} };
     }
 
-
-public:
-    position_t position;
-};
-
-
-class bust_command_t : public command_t
-{
-public:
-    bust_command_t(id_type owner_id, id_type ghost_id)
-        : command_t(type_t::BUST, owner_id), ghost_id(ghost_id)
+    static command_t make_stun(id_type owner_id, id_type enemy_id)
     {
+        return command_t { type_t::STUN, owner_id, enemy_id, {} };
     }
 
-    void execute(const std::string& message) const override
+    static command_t make_release(id_type owner_id)
     {
-        std::cout << "BUST " << ghost_id << " " << message << std::endl;
+        return command_t { type_t::RELEASE, owner_id, 0, {} };
     }
 
-
-public:
-    id_type ghost_id;
-};
-
-
-class stun_command_t : public command_t
-{
-public:
-    stun_command_t(id_type owner_id, id_type enemy_id)
-        : command_t(type_t::STUN, owner_id), enemy_id(enemy_id)
+    static command_t make_radar(id_type owner_id)
     {
+        return command_t { type_t::RADAR, owner_id, 0, {} };
     }
 
-    void execute(const std::string& message) const override
+    static command_t make_eject(id_type owner_id, position_t position)
     {
-        std::cout << "STUN " << enemy_id << " " << message << std::endl;
+        return command_t { type_t::EJECT, owner_id, 0, position };
     }
 
 
 public:
-    id_type enemy_id;
-};
-
+    command_t()
+        : command_t(type_t::MOVE, 0, 0, {})
+    {
+    }
 
-class release_command_t : public command_t
-{
-public:
-    release_command_t(id_type owner_id)
-        : command_t(type_t::RELEASE, owner_id)
+    command_t(type_t type, id_type owner_id, id_type target_id, position_t position)
+        : type(type), owner_id(owner_id), target_id(target_id), position(position)
     {
     }
 
-    void execute(const std::string& message) const override
+    void write(output_buffer_t& output, const std::string& message) const
     {
-        std::cout << "RELEASE" << " " << message << std::endl;
+        using writer_t = void (*)(output_buffer_t&, const command_t&);
+
+        // Ordered as `type_t` values
+        static const std::array<writer_t, TYPES_COUNT> writers
+        {
+            {
+                &command_t::write_bust,
+                &command_t::write_eject,
+                &command_t::write_move,
+                &command_t::write_radar,
+                &command_t::write_release,
+                &command_t::write_stun,
+            }
+        };
+
+        writers[static_cast<std::size_t>(type)](output, *this);
+        output << ' ' << message << '\n';
     }
-};
 
 
-class radar_command_t : public command_t
-{
-public:
-    radar_command_t(id_type owner_id)
-        : command_t(type_t::RADAR, owner_id)
+private:
+    static void write_bust(output_buffer_t& output, const command_t& command)
     {
+        output << "BUST " << command.target_id;
     }
 
-    void execute(const std::string& message) const override
+    static void write_eject(output_buffer_t& output, const command_t& command)
     {
-        std::cout << "RADAR" << " " << message << std::endl;
+        output << "EJECT " << command.position;
     }
-};
-
 
-class eject_command_t : public command_t
-{
-public:
-    struct params_t
+    static void write_move(output_buffer_t& output, const command_t& command)
     {
-        position_t position;
-        id_type buster_id;
-    };
-
+        output << "MOVE " << command.position;
+    }
 
-public:
-    eject_command_t(id_type owner_id, position_t position)
-        : command_t(type_t::EJECT, owner_id), position(position)
+    static void write_radar(output_buffer_t& output, const command_t& command)
     {
+        output << "RADAR";
     }
 
-    void execute(const std::string& message) const override
+    static void write_release(output_buffer_t& output, const command_t& command)
     {
-        std::cout << "EJECT " << position << " " << message << std::endl;
+        output << "RELEASE";
     }
 
-
-public:
-    position_t position;
+    static void write_stun(output_buffer_t& output, const command_t& command)
+    {
+        output << "STUN " << command.target_id;
+    }
 };
+
+static_assert(std::is_trivially_copyable<command_t>::value, "command_t should be passable as plain data");
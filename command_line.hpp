@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+
+// Parsing of command line options shared by standalone tools.
+
+// Parses comma separated list of non-negative integers (e.g. "2,3,4,5") into `result`. Returns `false` and leaves
+// `result` untouched if the list is empty or any entry isn't a number (e.g. "8,x", "8,,15", "-1" or too big one).
+bool parse_list(const char* text, std::vector<std::size_t>& result)
+{
+    std::vector<std::size_t> values;
+    const char* current = text;
+
+    do
+    {
+        if (*current < '0' || *current > '9')
+            return false;
+
+        std::size_t value = 0;
+        for (; *current >= '0' && *current <= '9'; ++current)
+        {
+            std::size_t digit = static_cast<std::size_t>(*current - '0');
+            if (value > (std::numeric_limits<std::size_t>::max() - digit) / 10)
+                return false;
+
+            value = value * 10 + digit;
+        }
+
+        values.push_back(value);
+    }
+    while (*current++ == ',');
+
+    // Loop above stops on first character which is neither digit nor separator, only end of text is fine
+    if (*(current - 1) != '\0')
+        return false;
+
+    result.swap(values);
+    return true;
+}
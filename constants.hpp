@@ -1,9 +1,18 @@
+#pragma once
+
+#include <cstddef>
 #include <map>
 #include <vector>
 
 #include "types.hpp"
 
 
+static const count_t MAX_GHOSTS_COUNT = 64;
+
+static const std::size_t MAX_TASKS_COUNT = 256; // capacity of task pool, oldest EXPLORE tasks are evicted beyond it
+
+static const unsigned int DEFAULT_RANDOM_SEED = 1;
+
 static const std::map<count_t, std::vector<position_t>> initial_goal_positions
 {
     {
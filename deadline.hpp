@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+
+
+// Point in time by which current round has to be finished, started as soon as round's input is read.
+// Stages of the round check how much time is left and drop to cheaper paths when it runs low.
+
+class deadline_t
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+
+public:
+    deadline_t()
+        : expiration(clock_t::time_point::max())
+    {
+    }
+
+    void start(clock_t::duration budget)
+    {
+        start(clock_t::now(), budget);
+    }
+
+    // Round which actually started earlier than its input was read (e.g. while previous one was still running)
+    void start(clock_t::time_point started_at, clock_t::duration budget)
+    {
+        expiration = started_at + budget;
+    }
+
+    clock_t::time_point get_expiration() const
+    {
+        return expiration;
+    }
+
+    clock_t::duration remaining() const
+    {
+        return expiration - clock_t::now();
+    }
+
+    bool has_at_least(clock_t::duration duration) const
+    {
+        return (remaining() >= duration);
+    }
+
+    bool is_expired() const
+    {
+        return (clock_t::now() >= expiration);
+    }
+
+
+private:
+    clock_t::time_point expiration;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#include "moves_table.hpp"
+#include "types.hpp"
+
+
+// Batched distance kernels.
+//
+// Points are kept as separate arrays of 32-bit coordinates, so that squared distances from one point to N points
+// are computed with AVX2/SSE4.1 when available and plain scalar loop otherwise. Every coordinate difference and its
+// square fit into 32 bits on game's map, so all variants give exactly the same results as `squared_distance_between`.
+
+class point_batch_t
+{
+public:
+    void clear()
+    {
+        xs.clear();
+        ys.clear();
+    }
+
+    void push_back(const position_t& position)
+    {
+        xs.push_back(static_cast<std::int32_t>(position.x));
+        ys.push_back(static_cast<std::int32_t>(position.y));
+    }
+
+    std::size_t size() const
+    {
+        return xs.size();
+    }
+
+
+public:
+    std::vector<std::int32_t> xs;
+    std::vector<std::int32_t> ys;
+};
+
+
+// `results[i]` is squared distance from `origin` to i-th point of `points`
+void squared_distances_from(const position_t& origin, const point_batch_t& points, std::int32_t* results)
+{
+    const std::int32_t ox = static_cast<std::int32_t>(origin.x);
+    const std::int32_t oy = static_cast<std::int32_t>(origin.y);
+    const std::int32_t* xs = points.xs.data();
+    const std::int32_t* ys = points.ys.data();
+    const std::size_t count = points.size();
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i vox = _mm256_set1_epi32(ox);
+    const __m256i voy = _mm256_set1_epi32(oy);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i)), vox);
+        __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i)), voy);
+        __m256i d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i), d2);
+    }
+#elif defined(__SSE4_1__)
+    const __m128i vox = _mm_set1_epi32(ox);
+    const __m128i voy = _mm_set1_epi32(oy);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i dx = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i)), vox);
+        __m128i dy = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i)), voy);
+        __m128i d2 = _mm_add_epi32(_mm_mullo_epi32(dx, dx), _mm_mullo_epi32(dy, dy));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), d2);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        std::int32_t dx = xs[i] - ox;
+        std::int32_t dy = ys[i] - oy;
+        results[i] = dx * dx + dy * dy;
+    }
+}
+
+// `results[i]` is `moves * weights[i] / divisor`, where `moves` is number of STEP long moves needed to reach i-th
+// point of `points` from `origin`, looked up in moves table by exact squared distance (so results are bitwise
+// identical to scalar `moves_from_squared_distance` based code). `squared_distances` is scratch buffer of at least
+// `points.size()` values.
+template <std::int64_t STEP>
+void weighted_moves_from(const position_t& origin, const point_batch_t& points, const double* weights, double divisor,
+    std::int32_t* squared_distances, double* results)
+{
+    squared_distances_from(origin, points, squared_distances);
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+        results[i] = (static_cast<double>(moves_table_t<STEP, 0>::moves(squared_distances[i])) * weights[i]) / divisor;
+}
@@ -0,0 +1,85 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "distance_kernels.hpp"
+#include "game_data.hpp"
+#include "utils.hpp"
+
+
+// Usage: distance_kernels_test
+//
+// Checks batched kernels (`squared_distances_from`, `weighted_moves_from`) against scalar `squared_distance_between`
+// and `moves_from_squared_distance` for map's corners and random points, in batches of every size up to a few
+// vector widths, so that vector loops and scalar tails are both covered. Build it also with `-mavx2` and `-msse4.1`
+// to check every variant. Writes first mismatches and exits with 1 if there is any.
+
+int main()
+{
+    const std::size_t MAX_BATCH_SIZE = 40;
+    const std::size_t ORIGINS_COUNT = 2000;
+    const std::size_t MAX_REPORTED = 10;
+    const double DIVISOR = 1.5;
+
+    std::mt19937 random_engine(DEFAULT_RANDOM_SEED);
+    auto get_random_position = [&random_engine]() {
+        return position_t(static_cast<coord_t>(random_engine() % 16001), static_cast<coord_t>(random_engine() % 9001));
+    };
+
+    const position_t corners[] = { { 0, 0 }, { 16000, 0 }, { 0, 9000 }, { 16000, 9000 } };
+
+    std::vector<position_t> origins(std::begin(corners), std::end(corners));
+    while (origins.size() < ORIGINS_COUNT)
+        origins.push_back(get_random_position());
+
+    std::size_t checked = 0;
+    std::size_t mismatches = 0;
+
+    for (std::size_t batch_size = 0; batch_size <= MAX_BATCH_SIZE; ++batch_size)
+    {
+        point_batch_t points;
+        std::vector<double> weights;
+
+        for (std::size_t i = 0; i < batch_size; ++i)
+        {
+            points.push_back((i < 4) ? corners[3 - i] : get_random_position());
+            weights.push_back(0.5 + (random_engine() % 100) / 50.0);
+        }
+
+        std::vector<std::int32_t> squared_distances(batch_size);
+        std::vector<double> weighted_moves(batch_size);
+
+        for (const position_t& origin : origins)
+        {
+            squared_distances_from(origin, points, squared_distances.data());
+            weighted_moves_from<800>(origin, points, weights.data(), DIVISOR, squared_distances.data(), weighted_moves.data());
+
+            for (std::size_t i = 0; i < batch_size; ++i)
+            {
+                const position_t point(static_cast<coord_t>(points.xs[i]), static_cast<coord_t>(points.ys[i]));
+                const std::int64_t expected_squared_distance = squared_distance_between(origin, point);
+                const double expected_weighted_moves = (moves_from_squared_distance(expected_squared_distance) * weights[i]) / DIVISOR;
+
+                // `weighted_moves_from` leaves squared distances of its last call in scratch buffer
+                if (squared_distances[i] != expected_squared_distance || weighted_moves[i] != expected_weighted_moves)
+                {
+                    if (mismatches < MAX_REPORTED)
+                    {
+                        std::cerr << "from " << origin << " to " << point << ": squared distance " << squared_distances[i]
+                            << " (expected " << expected_squared_distance << "), weighted moves " << weighted_moves[i]
+                            << " (expected " << expected_weighted_moves << ")" << std::endl;
+                    }
+
+                    ++mismatches;
+                }
+
+                ++checked;
+            }
+        }
+    }
+
+    std::cout << checked << " pairs checked, " << mismatches << " mismatches" << std::endl;
+
+    return (mismatches == 0) ? 0 : 1;
+}
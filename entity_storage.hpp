@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "entity.hpp"
+#include "types.hpp"
+
+
+// Fixed-capacity, id-indexed storage of entities visible in current round.
+//
+// Entities are kept as struct-of-arrays (x, y, state, value, stamina, ...) with presence bitmask, so that passes
+// over all entities are contiguous scans and lookups by id are plain array indexing. For the rest of the code
+// storage keeps `std::map<id_type, entity_type>`-like interface (`at`, `find`, `count` and iteration over
+// `(id, entity)` pairs), where entities are materialized on access.
+
+template <typename entity_type, std::size_t CAPACITY>
+class entity_storage_t
+{
+    static_assert(CAPACITY <= 64, "Presence of entities is tracked with 64-bit mask");
+
+
+public:
+    using value_type = std::pair<id_type, entity_type>;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = entity_storage_t::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = value_type;
+
+        const_iterator(const entity_storage_t* storage, id_type id)
+            : storage(storage), id(id)
+        {
+        }
+
+        value_type operator*() const
+        {
+            return { id, storage->get(id) };
+        }
+
+        const_iterator& operator++()
+        {
+            id = storage->next_present_id(id + 1);
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return (id == other.id);
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return (id != other.id);
+        }
+
+
+    private:
+        const entity_storage_t* storage;
+        id_type id;
+    };
+
+
+public:
+    entity_storage_t()
+        : presence(0), xs(), ys(), states(), values(), staminas(), busters_catching()
+    {
+    }
+
+    void clear()
+    {
+        presence = 0;
+    }
+
+    void insert(const buster_t& buster)
+    {
+        if (!mark_present(buster.id))
+            return;
+
+        xs[buster.id] = buster.position.x;
+        ys[buster.id] = buster.position.y;
+        states[buster.id] = buster.state;
+        values[buster.id] = buster.value;
+    }
+
+    void insert(const ghost_t& ghost)
+    {
+        if (!mark_present(ghost.id))
+            return;
+
+        xs[ghost.id] = ghost.position.x;
+        ys[ghost.id] = ghost.position.y;
+        staminas[ghost.id] = ghost.stamina;
+        busters_catching[ghost.id] = ghost.busters_catching;
+    }
+
+    entity_type at(id_type id) const
+    {
+        if (count(id) == 0)
+            throw std::out_of_range("entity_storage_t::at");
+
+        return get(id);
+    }
+
+    std::size_t count(id_type id) const
+    {
+        return (id < CAPACITY && (presence & (std::uint64_t(1) << id)) != 0) ? 1 : 0;
+    }
+
+    std::size_t size() const
+    {
+        std::size_t result = 0;
+
+        for (std::uint64_t mask = presence; mask != 0; mask &= (mask - 1))
+            ++result;
+
+        return result;
+    }
+
+    bool empty() const
+    {
+        return (presence == 0);
+    }
+
+    const_iterator begin() const
+    {
+        return { this, next_present_id(0) };
+    }
+
+    const_iterator end() const
+    {
+        return { this, CAPACITY };
+    }
+
+    const_iterator find(id_type id) const
+    {
+        return (count(id) > 0) ? const_iterator { this, id } : end();
+    }
+
+
+public: // Raw struct-of-arrays access, valid only for ids present in `presence_mask()`
+    std::uint64_t presence_mask() const
+    {
+        return presence;
+    }
+
+    const std::array<coord_t, CAPACITY>& positions_x() const
+    {
+        return xs;
+    }
+
+    const std::array<coord_t, CAPACITY>& positions_y() const
+    {
+        return ys;
+    }
+
+    const std::array<buster_t::state_t, CAPACITY>& buster_states() const
+    {
+        return states;
+    }
+
+    const std::array<value_t, CAPACITY>& buster_values() const
+    {
+        return values;
+    }
+
+    const std::array<count_t, CAPACITY>& ghost_staminas() const
+    {
+        return staminas;
+    }
+
+
+private:
+    bool mark_present(id_type id)
+    {
+        if (id >= CAPACITY)
+            return false; // not expected from game's input, such entity is ignored
+
+        presence |= (std::uint64_t(1) << id);
+        return true;
+    }
+
+    id_type next_present_id(id_type id) const
+    {
+        while (id < CAPACITY && (presence & (std::uint64_t(1) << id)) == 0)
+            ++id;
+
+        return id;
+    }
+
+    entity_type get(id_type id) const
+    {
+        entity_type result;
+        load(id, result);
+        return result;
+    }
+
+    void load(id_type id, buster_t& buster) const
+    {
+        buster.id = id;
+        buster.position = { xs[id], ys[id] };
+        buster.state = states[id];
+        buster.value = values[id];
+    }
+
+    void load(id_type id, ghost_t& ghost) const
+    {
+        ghost.id = id;
+        ghost.position = { xs[id], ys[id] };
+        ghost.stamina = staminas[id];
+        ghost.busters_catching = busters_catching[id];
+    }
+
+
+private:
+    std::uint64_t presence;
+    std::array<coord_t, CAPACITY> xs;
+    std::array<coord_t, CAPACITY> ys;
+    std::array<buster_t::state_t, CAPACITY> states; // for: busters
+    std::array<value_t, CAPACITY> values; // for: busters
+    std::array<count_t, CAPACITY> staminas; // for: ghosts
+    std::array<count_t, CAPACITY> busters_catching; // for: ghosts
+};
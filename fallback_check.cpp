@@ -0,0 +1,246 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "codebusters_referee.hpp"
+#include "command_line.hpp"
+
+
+// Usage: fallback_check [--games N] [--budgets-us 0,1000,85000] [--seed N]
+//
+// Plays in-process games in which bot of team 0 writes its commands to a temporary file, so that its watchdog runs
+// as on the judge, with round time budget overridden by one of `--budgets-us` (taken in turns per game; tiny ones
+// make watchdog's fallback commands win most rounds). Referee gets the commands which were actually written.
+// After every round bot's own bookkeeping (radar and stun usage, scored points) is compared with what follows
+// from the written commands. Writes every mismatch and exits with 1 if there is any.
+
+namespace
+{
+    struct check_result_t
+    {
+        std::size_t rounds;
+        std::size_t fallback_rounds;
+        std::size_t mismatches;
+    };
+
+    // Parses one written command line (message after the command is ignored)
+    command_t parse_command(const std::string& line, id_type owner_id)
+    {
+        std::istringstream stream(line);
+        std::string type;
+        stream >> type;
+
+        coord_t x = 0, y = 0;
+        id_type target_id = 0;
+
+        if (type == "MOVE" && stream >> x >> y)
+            return command_t::make_move(owner_id, position_t(x, y));
+        if (type == "EJECT" && stream >> x >> y)
+            return command_t::make_eject(owner_id, position_t(x, y));
+        if (type == "BUST" && stream >> target_id)
+            return command_t::make_bust(owner_id, target_id);
+        if (type == "STUN" && stream >> target_id)
+            return command_t::make_stun(owner_id, target_id);
+        if (type == "RELEASE")
+            return command_t::make_release(owner_id);
+        if (type == "RADAR")
+            return command_t::make_radar(owner_id);
+
+        throw std::invalid_argument("Unexpected written command: " + line);
+    }
+
+    // Lines written to file since given offset, which is moved past them
+    std::vector<std::string> read_written_lines(int fd, off_t& offset)
+    {
+        std::string text;
+        char buffer[4096];
+
+        for (ssize_t count; (count = ::pread(fd, buffer, sizeof(buffer), offset)) > 0; offset += count)
+            text.append(buffer, count);
+
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        for (std::string line; std::getline(stream, line);)
+            lines.push_back(line);
+
+        return lines;
+    }
+
+    template <count_t BUSTERS_COUNT>
+    check_result_t check_game(count_t ghosts_count, unsigned int random_seed, std::chrono::microseconds budget, int fd)
+    {
+        codebusters_referee_t<BUSTERS_COUNT> referee(ghosts_count, random_seed);
+
+        codebusters_player_t<BUSTERS_COUNT> player_0(referee.get_game_settings(0), referee.get_player_seed(0), fd);
+        codebusters_player_t<BUSTERS_COUNT> player_1(referee.get_game_settings(1), referee.get_player_seed(1), -1);
+        codebusters_player_t<BUSTERS_COUNT>* players[] = { &player_0, &player_1 };
+
+        player_0.set_round_time_budget(budget);
+
+        output_buffer_t round_data(-1);
+        std::array<command_t, BUSTERS_COUNT> written_commands;
+        off_t offset = ::lseek(fd, 0, SEEK_END);
+
+        // Expected bookkeeping of team 0, which owns buster ids [0, BUSTERS_COUNT)
+        std::bitset<2 * BUSTERS_COUNT> radar_usage;
+        std::array<round_num_t, 2 * BUSTERS_COUNT> stun_usage;
+        stun_usage.fill(NEVER_ROUND);
+        count_t releases = 0;
+
+        check_result_t result { 0, 0, 0 };
+
+        for (auto player : players)
+            player->start_game();
+
+        while (!referee.is_game_over())
+        {
+            for (id_type team_id = 0; team_id < 2; ++team_id)
+            {
+                round_data.clear();
+                referee.write_round_data(team_id, round_data);
+
+                input_reader_t reader(round_data.data(), round_data.size());
+                input::use_reader(reader);
+                players[team_id]->play_round();
+            }
+
+            std::vector<std::string> lines = read_written_lines(fd, offset);
+            if (lines.size() != BUSTERS_COUNT)
+                throw std::runtime_error("Round " + std::to_string(result.rounds) + " wrote " + std::to_string(lines.size()) + " commands");
+
+            bool fallback = false;
+            for (id_type id = 0; id < BUSTERS_COUNT; ++id)
+            {
+                written_commands[id] = parse_command(lines[id], id);
+
+                // Own commands of this round differ from written ones only when fallback ones won
+                const command_t& own_command = player_0.get_commands()[id];
+                if (written_commands[id].type != own_command.type || !(written_commands[id].position == own_command.position) ||
+                    written_commands[id].target_id != own_command.target_id)
+                    fallback = true;
+
+                switch (written_commands[id].type)
+                {
+                case command_t::type_t::RADAR:
+                    radar_usage.set(id);
+                    break;
+                case command_t::type_t::STUN:
+                    stun_usage[id] = static_cast<round_num_t>(result.rounds);
+                    break;
+                case command_t::type_t::RELEASE:
+                    ++releases;
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            result.fallback_rounds += fallback ? 1 : 0;
+
+            const tracking_data_t<BUSTERS_COUNT>& tracking_data = player_0.get_tracking_data();
+            bool mismatch = false;
+
+            for (id_type id = 0; id < BUSTERS_COUNT; ++id)
+                mismatch |= (tracking_data.radar_usage.test(id) != radar_usage.test(id)) || (tracking_data.buster_stun_usage[id] != stun_usage[id]);
+
+            // Ghosts lost within own base count as scored too
+            count_t points = player_0.get_points();
+            mismatch |= (points < releases) || (points > releases + tracking_data.lose_ghost_count);
+
+            if (mismatch)
+            {
+                std::cerr << "seed " << random_seed << " busters " << BUSTERS_COUNT << " ghosts " << ghosts_count << " round " << result.rounds
+                    << ": radar " << tracking_data.radar_usage.to_string() << " (written " << radar_usage.to_string() << "), points "
+                    << points << " (written releases " << releases << ")" << std::endl;
+                ++result.mismatches;
+            }
+
+            referee.play_round(written_commands, player_1.get_commands());
+            ++result.rounds;
+        }
+
+        input::use_default_reader();
+
+        for (auto player : players)
+            player->finish_game();
+
+        return result;
+    }
+
+    check_result_t check_game(count_t busters_count, count_t ghosts_count, unsigned int random_seed, std::chrono::microseconds budget, int fd)
+    {
+        switch (busters_count)
+        {
+        case 2:
+            return check_game<2>(ghosts_count, random_seed, budget, fd);
+        case 3:
+            return check_game<3>(ghosts_count, random_seed, budget, fd);
+        case 4:
+            return check_game<4>(ghosts_count, random_seed, budget, fd);
+        case 5:
+            return check_game<5>(ghosts_count, random_seed, budget, fd);
+        default:
+            throw std::out_of_range("Unsupported number of busters per player");
+        }
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::size_t games = 24;
+    std::vector<std::size_t> budgets { 0, 1000, 85000 };
+    unsigned int random_seed = DEFAULT_RANDOM_SEED;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--budgets-us") == 0 && !parse_list(argv[i + 1], budgets))
+        {
+            std::cerr << "Invalid list of numbers: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else if (std::strcmp(argv[i], "--games") == 0)
+            games = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            random_seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    char path[] = "/tmp/fallback_check_XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd < 0)
+    {
+        std::cerr << "Can't create temporary file" << std::endl;
+        return 1;
+    }
+
+    ::unlink(path);
+
+    const count_t ghosts_counts[] = { 8, 15, 28 };
+    check_result_t total { 0, 0, 0 };
+
+    for (std::size_t game = 0; game < games; ++game)
+    {
+        count_t busters_count = static_cast<count_t>(2 + game % 4);
+        count_t ghosts_count = ghosts_counts[game % 3];
+        std::chrono::microseconds budget(budgets[game % budgets.size()]);
+
+        check_result_t result = check_game(busters_count, ghosts_count, random_seed + static_cast<unsigned int>(game), budget, fd);
+
+        total.rounds += result.rounds;
+        total.fallback_rounds += result.fallback_rounds;
+        total.mismatches += result.mismatches;
+    }
+
+    ::close(fd);
+
+    std::cout << games << " games, " << total.rounds << " rounds, " << total.fallback_rounds << " with fallback commands, "
+        << total.mismatches << " mismatches" << std::endl;
+
+    return (total.mismatches == 0) ? 0 : 1;
+}
@@ -1,48 +1,147 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <array>
 #include <vector>
 
+#include "constants.hpp"
 #include "entity.hpp"
+#include "entity_storage.hpp"
+#include "spatial_index.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 
 
-class game_data_t
+// Game's settings given in initialization input.
+
+struct game_settings_t
+{
+    id_type team_id;
+    count_t busters_count; // per player
+    count_t ghosts_count; // total
+};
+
+
+// Game's rules constants.
+
+class game_constants_t
+{
+public:
+    static constexpr position_t map_size { 16001, 9001 };
+
+    static constexpr double MOVE_RANGE = 800.0;
+    static constexpr double BUST_RANGE_MIN = 900.0;
+    static constexpr double BUST_RANGE_MAX = 1760.0;
+    static constexpr double STUN_RANGE = 1760.0;
+    static constexpr double BASE_RELEASE_RANGE = 1600.0;
+    static constexpr double VISION_RANGE = 2200.0;
+    static constexpr double RADAR_VISION_RANGE = 4400.0;
+    static constexpr double EJECT_RANGE = 1760.0;
+    static constexpr double GHOST_MOVE_RANGE = 400.0;
+
+    static constexpr count_t STUN_TIMEOUT = 11;
+    static constexpr count_t STUN_COOLDOWN = 21;
+
+    static constexpr round_num_t ROUND_COUNT = 250; // rounds per game (per player)
+
+    static constexpr bool INSERT_CARRIED_GHOST = true;
+};
+
+constexpr position_t game_constants_t::map_size;
+constexpr double game_constants_t::MOVE_RANGE;
+constexpr double game_constants_t::BUST_RANGE_MIN;
+constexpr double game_constants_t::BUST_RANGE_MAX;
+constexpr double game_constants_t::STUN_RANGE;
+constexpr double game_constants_t::BASE_RELEASE_RANGE;
+constexpr double game_constants_t::VISION_RANGE;
+constexpr double game_constants_t::RADAR_VISION_RANGE;
+constexpr double game_constants_t::EJECT_RANGE;
+constexpr double game_constants_t::GHOST_MOVE_RANGE;
+constexpr count_t game_constants_t::STUN_TIMEOUT;
+constexpr count_t game_constants_t::STUN_COOLDOWN;
+constexpr round_num_t game_constants_t::ROUND_COUNT;
+constexpr bool game_constants_t::INSERT_CARRIED_GHOST;
+
+
+// Entities visible in a single round.
+
+template <count_t BUSTERS_COUNT>
+class round_entities_t
+{
+public:
+    using busters_storage_t = entity_storage_t<buster_t, 2 * BUSTERS_COUNT>;
+    using ghosts_storage_t = entity_storage_t<ghost_t, MAX_GHOSTS_COUNT>;
+
+
+public:
+    void clear()
+    {
+        busters.clear();
+        enemies.clear();
+        ghosts.clear();
+    }
+
+
+public:
+    busters_storage_t busters; // indexed by id, ids are in [0, 2 * busters_count)
+    busters_storage_t enemies; // -||-
+    ghosts_storage_t ghosts; // indexed by id, ids are in [0, ghosts_count)
+};
+
+
+// All game data recieved as input, specialized on number of busters per player.
+
+template <count_t BUSTERS_COUNT>
+class game_data_t : public game_constants_t
 {
 public:
-    game_data_t(id_type team_id, count_t busters_count, count_t ghosts_count)
-        : team_id(team_id),
-        busters_count(busters_count),
-        ghosts_count(ghosts_count),
-        base_position(team_id),
-        map_size({ 16001, 9001 }),
+    using entities_t = round_entities_t<BUSTERS_COUNT>;
+    using busters_storage_t = typename entities_t::busters_storage_t;
+    using ghosts_storage_t = typename entities_t::ghosts_storage_t;
+
+
+public:
+    explicit game_data_t(const game_settings_t& settings)
+        : team_id(settings.team_id),
+        ghosts_count(settings.ghosts_count),
+        base_position(settings.team_id),
         points(0),
-        round(0)
+        round(0),
+        current_entities(0),
+        busters_index(map_size, static_cast<coord_t>(VISION_RANGE)),
+        enemies_index(map_size, static_cast<coord_t>(STUN_RANGE)),
+        ghosts_index(map_size, static_cast<coord_t>(BUST_RANGE_MAX))
+    {
+    }
+
+    // Current round's entities become previous ones (without copying anything) and buffer of the round before
+    // is reused for the next round
+    void swap_round_buffers()
     {
+        current_entities = 1 - current_entities;
     }
 
     void prepare_for_next_round()
     {
-        busters.clear();
-        enemies.clear();
-        ghosts.clear();
+        entities().clear();
+    }
+
+    // Must be called once all entities of current round are inserted
+    void build_spatial_indices()
+    {
+        build_spatial_index(busters_index, busters());
+        build_spatial_index(enemies_index, enemies());
+        build_spatial_index(ghosts_index, ghosts());
     }
 
     void insert_buster(id_type id, position_t position, buster_t::state_t state, value_t value)
     {
-        busters[id].id = id;
-        busters[id].position = position;
-        busters[id].state = state;
-        busters[id].value = value;
+        busters().insert(make_buster(id, position, state, value));
     }
 
     void insert_enemy(id_type id, position_t position, buster_t::state_t state, value_t value)
     {
-        enemies[id].id = id;
-        enemies[id].position = position;
-        enemies[id].state = state;
-        enemies[id].value = value;
+        enemies().insert(make_buster(id, position, state, value));
 
         if (INSERT_CARRIED_GHOST && state == buster_t::state_t::CARRY_GHOST)
             insert_ghost(static_cast<id_type>(value), position, 0, 1);
@@ -50,10 +149,13 @@ public:
 
     void insert_ghost(id_type id, position_t position, count_t stamina, count_t busters_catching)
     {
-        ghosts[id].id = id;
-        ghosts[id].position = position;
-        ghosts[id].stamina = stamina;
-        ghosts[id].busters_catching = busters_catching;
+        ghost_t ghost;
+        ghost.id = id;
+        ghost.position = position;
+        ghost.stamina = stamina;
+        ghost.busters_catching = busters_catching;
+
+        ghosts().insert(ghost);
     }
 
     void count_new_point()
@@ -67,15 +169,101 @@ public:
     }
 
 
+private:
+    template <typename storage_type>
+    static void build_spatial_index(spatial_index_t& index, const storage_type& storage)
+    {
+        index.clear();
+
+        for (const auto& id_entity_pair : storage)
+            index.insert(id_entity_pair.first, id_entity_pair.second.position);
+    }
+
+    // Ids of indexed entities within range, in increasing order
+    static std::vector<id_type> get_within_range(const spatial_index_t& index, const position_t& position, double range)
+    {
+        std::vector<id_type> results;
+
+        index.for_each_near(position, range, [&results, &position, range](const spatial_index_t::entry_t& entry) {
+            if (is_within_range(position, entry.position, range))
+                results.push_back(entry.id);
+        });
+
+        std::sort(results.begin(), results.end());
+        return results;
+    }
+
+    static buster_t make_buster(id_type id, position_t position, buster_t::state_t state, value_t value)
+    {
+        buster_t buster;
+        buster.id = id;
+        buster.position = position;
+        buster.state = state;
+        buster.value = value;
+
+        return buster;
+    }
+
+
 public:
+    entities_t& entities()
+    {
+        return entities_buffers[current_entities];
+    }
+
+    const entities_t& entities() const
+    {
+        return entities_buffers[current_entities];
+    }
+
+    const entities_t& previous_entities() const
+    {
+        return entities_buffers[1 - current_entities];
+    }
+
+    busters_storage_t& busters()
+    {
+        return entities().busters;
+    }
+
+    busters_storage_t& enemies()
+    {
+        return entities().enemies;
+    }
+
+    ghosts_storage_t& ghosts()
+    {
+        return entities().ghosts;
+    }
+
+    const busters_storage_t& busters() const
+    {
+        return entities().busters;
+    }
+
+    const busters_storage_t& enemies() const
+    {
+        return entities().enemies;
+    }
+
+    const ghosts_storage_t& ghosts() const
+    {
+        return entities().ghosts;
+    }
+
     bool need_one_ghost_more() const
     {
         return ((ghosts_count - 1) / 2 <= points);
     }
 
+    std::size_t get_buster_index(id_type buster_id) const
+    {
+        return (buster_id - team_id * busters_count);
+    }
+
     bool is_in_base_range(const position_t& position) const
     {
-        return (distance_between(position, base_position.own) <= BASE_RELEASE_RANGE);
+        return is_within_range(position, base_position.own, BASE_RELEASE_RANGE);
     }
 
     bool is_in_base_range(const buster_t& buster) const
@@ -98,7 +286,7 @@ public:
         return { map_size.x - position.x - 1, map_size.y - position.y - 1 };
     }
 
-    position_t get_clamped_position(double x, double y)
+    static position_t get_clamped_position(double x, double y)
     {
         double map_size_x = static_cast<double>(map_size.x);
         double map_size_y = static_cast<double>(map_size.y);
@@ -126,17 +314,30 @@ public:
         return result;
     }
 
-    std::vector<id_type> get_enemies_within_range(const buster_t& buster, double range)
+    std::vector<id_type> get_busters_within_range(const position_t& position, double range) const
     {
-        std::vector<id_type> results;
+        return get_within_range(busters_index, position, range);
+    }
 
-        for (const auto& id_enemy_pair : enemies)
-        {
-            if (distance_between(buster, id_enemy_pair.second) <= range)
-                results.push_back(id_enemy_pair.first);
-        }
+    std::vector<id_type> get_enemies_within_range(const buster_t& buster, double range) const
+    {
+        return get_within_range(enemies_index, buster.position, range);
+    }
 
-        return results;
+    std::vector<id_type> get_ghosts_within_range(const position_t& position, double range) const
+    {
+        return get_within_range(ghosts_index, position, range);
+    }
+
+    // Same as `get_bust_moves_from_distance(sqrt(squared_distance))`, but from lookup tables and without `sqrt`
+    count_t get_bust_moves_from_squared_distance(std::int64_t squared_distance) const
+    {
+        if (squared_distance < squared_range(BUST_RANGE_MIN))
+            return moves_from_squared_distance(squared_distance);
+        else if (squared_range(BUST_RANGE_MAX) < squared_distance)
+            return moves_table_t<static_cast<std::int64_t>(MOVE_RANGE), static_cast<std::int64_t>((BUST_RANGE_MIN + BUST_RANGE_MAX) / 2.0)>::moves(squared_distance);
+        else
+            return 0;
     }
 
     count_t get_bust_moves_from_distance(double distance)
@@ -151,28 +352,26 @@ public:
 
 
 public:
+    static constexpr count_t busters_count = BUSTERS_COUNT; // per player
+
     const id_type team_id;
-    const count_t busters_count; // per player
     const count_t ghosts_count; // total
     const base_position_t base_position;
-    const position_t map_size;
 
     count_t points;
     round_num_t round;
-    std::map<id_type, buster_t> busters;
-    std::map<id_type, buster_t> enemies;
-    std::map<id_type, ghost_t>  ghosts;
 
 
-public:
-    const double MOVE_RANGE = 800.0;
-    const double BUST_RANGE_MIN = 900.0;
-    const double BUST_RANGE_MAX = 1760.0;
-    const double STUN_RANGE = 1760.0;
-    const double BASE_RELEASE_RANGE = 1600.0;
+private:
+    std::array<entities_t, 2> entities_buffers; // current and previous round, roles swapped each round
+    std::size_t current_entities; // index of current round's buffer
 
-    const count_t STUN_TIMEOUT = 11;
-    const count_t STUN_COOLDOWN = 21;
 
-    const bool INSERT_CARRIED_GHOST = true;
+private: // Spatial indices of current round's entities, cells are sized to typical query ranges
+    spatial_index_t busters_index;
+    spatial_index_t enemies_index;
+    spatial_index_t ghosts_index;
 };
+
+template <count_t BUSTERS_COUNT>
+constexpr count_t game_data_t<BUSTERS_COUNT>::busters_count;
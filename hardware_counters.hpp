@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+// Build with `-DPROFILE_HARDWARE_COUNTERS=1` (Linux only) to count hardware events around phases of the round.
+#ifndef PROFILE_HARDWARE_COUNTERS
+#define PROFILE_HARDWARE_COUNTERS 0
+#endif
+
+
+// Hardware performance counters of calling thread (cycles, instructions, L1 data cache read misses, last level
+// cache misses and branch misses), opened as one `perf_event_open` group so that all of them are read at once.
+// Events which can't be opened (not supported by CPU or virtual machine, restricted by `perf_event_paranoid`)
+// are reported as unavailable, the rest is still counted.
+
+class hardware_counters_t
+{
+public:
+#if defined(__linux__)
+    static const bool ENABLED = (PROFILE_HARDWARE_COUNTERS != 0);
+#else
+    static const bool ENABLED = false;
+#endif
+
+    enum class event_t
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_READ_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+    };
+
+    static const std::size_t EVENTS_COUNT = 5;
+
+    using values_t = std::array<std::uint64_t, EVENTS_COUNT>;
+
+
+public:
+    hardware_counters_t()
+        : leader_fd(-1), opened_count(0)
+    {
+        descriptors.fill(-1);
+        slots.fill(EVENTS_COUNT);
+
+        if (ENABLED)
+            open_all();
+    }
+
+    ~hardware_counters_t()
+    {
+#if defined(__linux__)
+        for (int fd : descriptors)
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+#endif
+    }
+
+    hardware_counters_t(const hardware_counters_t&) = delete;
+    hardware_counters_t& operator=(const hardware_counters_t&) = delete;
+
+    bool is_available(event_t event) const
+    {
+        return (descriptors[static_cast<std::size_t>(event)] >= 0);
+    }
+
+    // Current values of all events since counters were opened (unavailable ones read as 0)
+    values_t read_values() const
+    {
+        values_t result;
+        result.fill(0);
+
+#if defined(__linux__)
+        if (leader_fd < 0)
+            return result;
+
+        // PERF_FORMAT_GROUP layout: number of events followed by their values in order of opening
+        std::uint64_t buffer[1 + EVENTS_COUNT];
+        if (read(leader_fd, buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + opened_count)))
+            return result;
+
+        for (std::size_t i = 0; i < EVENTS_COUNT; ++i)
+        {
+            if (slots[i] < opened_count)
+                result[i] = buffer[1 + slots[i]];
+        }
+#endif
+
+        return result;
+    }
+
+    static const char* get_name(event_t event)
+    {
+        static const char* const NAMES[EVENTS_COUNT] = { "cycles", "instructions", "l1d_read_misses", "llc_misses", "branch_misses" };
+        return NAMES[static_cast<std::size_t>(event)];
+    }
+
+
+private:
+    void open_all()
+    {
+#if defined(__linux__)
+        const std::uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        open(event_t::CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(event_t::INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(event_t::L1D_READ_MISSES, PERF_TYPE_HW_CACHE, L1D_READ_MISS);
+        open(event_t::LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open(event_t::BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+        if (leader_fd >= 0)
+        {
+            ioctl(leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+#if defined(__linux__)
+    void open(event_t event, std::uint32_t type, std::uint64_t config)
+    {
+        perf_event_attr attributes = perf_event_attr();
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.disabled = (leader_fd < 0) ? 1 : 0; // group is enabled at once through its leader
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP;
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader_fd, 0));
+        if (fd < 0)
+            return;
+
+        if (leader_fd < 0)
+            leader_fd = fd;
+
+        descriptors[static_cast<std::size_t>(event)] = fd;
+        slots[static_cast<std::size_t>(event)] = opened_count++;
+    }
+#endif
+
+
+private:
+    int leader_fd;
+    std::size_t opened_count;
+    std::array<int, EVENTS_COUNT> descriptors; // per event, -1 if unavailable
+    std::array<std::size_t, EVENTS_COUNT> slots; // per event, position in group read, EVENTS_COUNT if unavailable
+};
+
+const std::size_t hardware_counters_t::EVENTS_COUNT;
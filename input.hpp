@@ -3,39 +3,140 @@
 #include <iostream>
 
 #include "game_data.hpp"
+#include "input_reader.hpp"
 
 
 class input
 {
 public:
-    static game_data_t read_game_data()
+    static game_settings_t read_game_settings()
     {
         count_t busters_count;
         count_t ghosts_count;
         id_type team_id;
 
-        std::cin >> busters_count; std::cin.ignore();
-        std::cin >> ghosts_count;  std::cin.ignore();
-        std::cin >> team_id;       std::cin.ignore();
+        if (USE_BUFFERED_READER)
+        {
+            busters_count = reader().read_integer<count_t>();
+            ghosts_count = reader().read_integer<count_t>();
+            team_id = reader().read_integer<id_type>();
+        }
+        else
+        {
+            std::cin >> busters_count; std::cin.ignore();
+            std::cin >> ghosts_count;  std::cin.ignore();
+            std::cin >> team_id;       std::cin.ignore();
+        }
 
-        return game_data_t { team_id, busters_count, ghosts_count };
+        return game_settings_t { team_id, busters_count, ghosts_count };
     }
 
-    static void read_round_data(game_data_t& game_data)
+    static bool has_round_data()
+    {
+        if (USE_BUFFERED_READER)
+            return !reader().end_of_input();
+
+        return !(std::cin >> std::ws).eof();
+    }
+
+    template <typename game_data_type>
+    static void read_round_data(game_data_type& game_data)
     {
         game_data.prepare_for_next_round();
 
-        count_t entities_count;
-        std::cin >> entities_count;
-        std::cin.ignore();
+        if (USE_BUFFERED_READER)
+        {
+            count_t entities_count = reader().read_integer<count_t>();
+
+            for (std::size_t i = 0; i < entities_count; ++i)
+                read_entity_data(reader(), game_data);
+        }
+        else
+        {
+            count_t entities_count;
+            std::cin >> entities_count;
+            std::cin.ignore();
 
-        for (std::size_t i = 0; i < entities_count; ++i)
-            read_entity_data(game_data);
+            for (std::size_t i = 0; i < entities_count; ++i)
+                read_entity_data(game_data);
+        }
+
+        game_data.build_spatial_indices();
+    }
+
+
+    // Replaces source of game input (e.g. with in-memory recorded game) for calling thread, only for buffered reader
+    static void use_reader(input_reader_t& reader)
+    {
+        current_reader() = &reader;
+    }
+
+    // Switches source of game input of calling thread back to standard input
+    static void use_default_reader()
+    {
+        current_reader() = &default_reader();
+    }
+
+    // Tees raw game input into given file descriptor, only for buffered reader
+    static void record_to(int fd)
+    {
+        reader().record_to(fd);
     }
 
 
 private:
-    static void read_entity_data(game_data_t& game_data)
+    static input_reader_t& reader()
+    {
+        return *current_reader();
+    }
+
+    static input_reader_t& default_reader()
+    {
+        static input_reader_t stdin_reader;
+        return stdin_reader;
+    }
+
+    // Per thread, so that games can be played in-process on many threads at once
+    static input_reader_t*& current_reader()
+    {
+        static thread_local input_reader_t* instance = &default_reader();
+        return instance;
+    }
+
+    template <typename game_data_type>
+    static void read_entity_data(input_reader_t& reader, game_data_type& game_data)
+    {
+        const int GHOST_TYPE = -1;
+
+        id_type id = reader.read_integer<id_type>();
+        coord_t x = reader.read_integer<coord_t>();
+        coord_t y = reader.read_integer<coord_t>();
+        int type = reader.read_integer<int>();
+
+        if (type == GHOST_TYPE)
+        {
+            count_t stamina = reader.read_integer<count_t>();
+            count_t busters_catching = reader.read_integer<count_t>();
+
+            game_data.insert_ghost(id, { x, y }, stamina, busters_catching);
+        }
+        else
+        {
+            id_type team_id = static_cast<id_type>(type);
+            std::size_t state_value = reader.read_integer<std::size_t>();
+            value_t value = reader.read_integer<value_t>();
+
+            buster_t::state_t state = static_cast<buster_t::state_t>(state_value);
+
+            if (team_id == game_data.team_id)
+                game_data.insert_buster(id, { x, y }, state, value);
+            else
+                game_data.insert_enemy(id, { x, y }, state, value);
+        }
+    }
+
+    template <typename game_data_type>
+    static void read_entity_data(game_data_type& game_data)
     {
         const int GHOST_TYPE = -1;
 
@@ -75,4 +176,8 @@ private:
                 game_data.insert_enemy(id, position, state, value);
         }
     }
+
+
+public:
+    static const bool USE_BUFFERED_READER = true; // `false` switches back to `std::cin`-based parsing
 };
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <unistd.h>
+
+
+// Buffered reader of whitespace-separated integers.
+//
+// Everything available on the file descriptor is pulled in with a single `read()` call (which on the judge is
+// the whole round block), then integers are parsed by hand without any locale or stream state involved.
+// Buffer is refilled only when parser runs out of data in the middle of the input.
+//
+// Reader can also parse directly from memory (used to replay recorded games) and tee every raw chunk read
+// from the file descriptor into a record file.
+
+class input_reader_t
+{
+public:
+    explicit input_reader_t(int fd = STDIN_FILENO)
+        : fd(fd), record_fd(-1), current(nullptr), last(nullptr), eof(false)
+    {
+    }
+
+    input_reader_t(const char* data, std::size_t size)
+        : fd(-1), record_fd(-1), current(data), last(data + size), eof(false)
+    {
+    }
+
+    void record_to(int fd)
+    {
+        record_fd = fd;
+    }
+
+    template <typename T>
+    T read_integer()
+    {
+        skip_whitespaces();
+
+        bool negative = false;
+        if (has_data() && *current == '-')
+        {
+            negative = true;
+            ++current;
+        }
+
+        long long int result = 0;
+        while (has_data() && is_digit(*current))
+        {
+            result = result * 10 + (*current - '0');
+            ++current;
+        }
+
+        return static_cast<T>(negative ? -result : result);
+    }
+
+    bool end_of_input()
+    {
+        skip_whitespaces();
+        return !has_data();
+    }
+
+
+private:
+    static bool is_digit(char c)
+    {
+        return (c >= '0' && c <= '9');
+    }
+
+    void skip_whitespaces()
+    {
+        while (has_data() && !is_digit(*current) && *current != '-')
+            ++current;
+    }
+
+    bool has_data()
+    {
+        return (current < last || refill());
+    }
+
+    bool refill()
+    {
+        if (eof || fd < 0)
+            return false;
+
+        ssize_t bytes_read = ::read(fd, buffer.data(), buffer.size());
+        if (bytes_read <= 0)
+        {
+            eof = true;
+            return false;
+        }
+
+        current = buffer.data();
+        last = current + bytes_read;
+
+        if (record_fd >= 0)
+            record(current, static_cast<std::size_t>(bytes_read));
+
+        return true;
+    }
+
+    void record(const char* data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t result = ::write(record_fd, data, size);
+            if (result <= 0)
+                break;
+
+            data += result;
+            size -= static_cast<std::size_t>(result);
+        }
+    }
+
+
+private:
+    int fd;
+    int record_fd;
+    const char* current;
+    const char* last;
+    bool eof;
+    std::array<char, 1 << 16> buffer;
+};
@@ -1,10 +1,54 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+
 #include "codebusters_player.hpp"
 
 
-int main()
+// Usage: codebusters [--seed N] [--record FILE] [--params FILE]
+//
+// With `--record` every raw input block is teed into FILE, preceded by a line with random seed used by the bot,
+// so that the game can be reproduced offline with `replay`. With `--params` strategy parameters are loaded from
+// FILE (e.g. written by `tune`).
+
+int main(int argc, char* argv[])
 {
-    codebusters_player_t player;
-    player.play();
+    unsigned int random_seed = DEFAULT_RANDOM_SEED;
+    const char* record_path = nullptr;
+    strategy_params_t params;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+            random_seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--record") == 0)
+            record_path = argv[i + 1];
+        else if (std::strcmp(argv[i], "--params") == 0 && !params.load(argv[i + 1]))
+        {
+            std::cerr << "Can't load strategy parameters: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+    }
+
+    if (record_path)
+    {
+        int record_fd = ::open(record_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (record_fd < 0)
+        {
+            std::cerr << "Can't open record file: " << record_path << std::endl;
+            return 1;
+        }
+
+        std::string header = std::to_string(random_seed) + "\n";
+        if (::write(record_fd, header.data(), header.size()) != static_cast<ssize_t>(header.size()))
+            return 1;
+
+        input::record_to(record_fd);
+    }
+
+    play_codebusters(input::read_game_settings(), random_seed, STDOUT_FILENO, params);
 
     return 0;
 }
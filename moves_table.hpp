@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "types.hpp"
+
+
+// Compile-time list of indices [0, N), built with logarithmic template recursion depth.
+
+template <std::size_t... I>
+struct index_list_t
+{
+    using type = index_list_t;
+};
+
+template <typename first_type, typename second_type>
+struct merge_index_lists_t;
+
+template <std::size_t... A, std::size_t... B>
+struct merge_index_lists_t<index_list_t<A...>, index_list_t<B...>>
+    : index_list_t<A..., (sizeof...(A) + B)...>
+{
+};
+
+template <std::size_t N>
+struct make_index_list_t
+    : merge_index_lists_t<typename make_index_list_t<N / 2>::type, typename make_index_list_t<N - N / 2>::type>
+{
+};
+
+template <>
+struct make_index_list_t<0> : index_list_t<>
+{
+};
+
+template <>
+struct make_index_list_t<1> : index_list_t<0>
+{
+};
+
+
+// Moves needed to get within OFFSET of a target at squared distance, moving STEP per move.
+
+template <std::int64_t STEP, std::int64_t OFFSET>
+constexpr std::int64_t moves_threshold(count_t moves)
+{
+    return (OFFSET + STEP * static_cast<std::int64_t>(moves)) * (OFFSET + STEP * static_cast<std::int64_t>(moves));
+}
+
+template <std::int64_t STEP, std::int64_t OFFSET>
+constexpr count_t moves_for_squared_distance(std::int64_t squared_distance, count_t moves = 0)
+{
+    return (squared_distance <= moves_threshold<STEP, OFFSET>(moves))
+        ? moves
+        : moves_for_squared_distance<STEP, OFFSET>(squared_distance, moves + 1);
+}
+
+
+// Lookup table of moves needed to get within OFFSET of a target at given distance, moving STEP per move,
+// i.e. `ceil((distance - OFFSET) / STEP)` (or 0 if already within OFFSET), keyed by squared integer distance.
+//
+// Squared distances are quantized into buckets of 2^SHIFT. Bucket is narrower than the gap between any two
+// consecutive thresholds `(OFFSET + STEP * k)^2`, so the table holds result for bucket's lower bound and
+// at most one integer comparison corrects it within the bucket. No floating point is involved.
+
+template <std::int64_t STEP, std::int64_t OFFSET, unsigned SHIFT, typename indices_type>
+struct moves_table_entries_t;
+
+template <std::int64_t STEP, std::int64_t OFFSET, unsigned SHIFT, std::size_t... I>
+struct moves_table_entries_t<STEP, OFFSET, SHIFT, index_list_t<I...>>
+{
+    static constexpr std::uint8_t entries[sizeof...(I)] = {
+        static_cast<std::uint8_t>(moves_for_squared_distance<STEP, OFFSET>(static_cast<std::int64_t>(I) << SHIFT))...
+    };
+};
+
+template <std::int64_t STEP, std::int64_t OFFSET, unsigned SHIFT, std::size_t... I>
+constexpr std::uint8_t moves_table_entries_t<STEP, OFFSET, SHIFT, index_list_t<I...>>::entries[];
+
+template <std::int64_t STEP, std::int64_t OFFSET>
+class moves_table_t
+{
+public:
+    static const unsigned SHIFT = 19;
+    static const std::int64_t MAX_SQUARED_DISTANCE = 16001ll * 16001ll + 9001ll * 9001ll; // map's diagonal
+    static const std::size_t SIZE = static_cast<std::size_t>(MAX_SQUARED_DISTANCE >> SHIFT) + 1;
+
+    static_assert(STEP * (2 * OFFSET + STEP) > (1ll << SHIFT), "Buckets must be narrower than gaps between thresholds");
+
+    using entries_t = moves_table_entries_t<STEP, OFFSET, SHIFT, typename make_index_list_t<SIZE>::type>;
+
+
+public:
+    static count_t moves(std::int64_t squared_distance)
+    {
+        std::size_t key = static_cast<std::size_t>(squared_distance >> SHIFT);
+        if (key >= SIZE)
+            return moves_for_squared_distance<STEP, OFFSET>(squared_distance);
+
+        count_t result = entries_t::entries[key];
+        if (squared_distance > moves_threshold<STEP, OFFSET>(result))
+            ++result;
+
+        return result;
+    }
+};
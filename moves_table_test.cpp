@@ -0,0 +1,49 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "game_data.hpp"
+#include "moves_table.hpp"
+#include "utils.hpp"
+
+
+// Usage: moves_table_test
+//
+// Checks lookup-table move counts (`moves_from_squared_distance`, `get_bust_moves_from_squared_distance`) against
+// floating point ones (`moves_from_distance`, `get_bust_moves_from_distance`) for every squared distance up to
+// the map's diagonal. Writes first mismatches and exits with 1 if there is any.
+
+int main()
+{
+    const std::int64_t MAX_SQUARED_DISTANCE = 16001ll * 16001ll + 9001ll * 9001ll;
+    const std::size_t MAX_REPORTED = 10;
+
+    game_data_t<2> game_data(game_settings_t { 0, 2, 8 });
+    std::size_t mismatches = 0;
+
+    for (std::int64_t squared_distance = 0; squared_distance <= MAX_SQUARED_DISTANCE; ++squared_distance)
+    {
+        const double distance = std::sqrt(static_cast<double>(squared_distance));
+
+        count_t moves = moves_from_squared_distance(squared_distance);
+        count_t expected_moves = moves_from_distance(distance);
+
+        count_t bust_moves = game_data.get_bust_moves_from_squared_distance(squared_distance);
+        count_t expected_bust_moves = game_data.get_bust_moves_from_distance(distance);
+
+        if (moves != expected_moves || bust_moves != expected_bust_moves)
+        {
+            if (mismatches < MAX_REPORTED)
+            {
+                std::cerr << "squared distance " << squared_distance << ": moves " << moves << " (expected " << expected_moves
+                    << "), bust moves " << bust_moves << " (expected " << expected_bust_moves << ")" << std::endl;
+            }
+
+            ++mismatches;
+        }
+    }
+
+    std::cout << (MAX_SQUARED_DISTANCE + 1) << " squared distances checked, " << mismatches << " mismatches" << std::endl;
+
+    return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <unistd.h>
+
+#include "types.hpp"
+
+
+// Per-round output sink.
+//
+// All commands of a round are formatted into a preallocated buffer and written with a single `write()` call
+// on `flush()`. Buffer can also be read back directly (`data()`/`size()`) to capture bot's output in-process.
+// Negative file descriptor discards flushed output; such capture buffer throws when it overflows instead,
+// since making room would silently drop what was captured so far.
+
+class output_buffer_t
+{
+public:
+    explicit output_buffer_t(int fd = STDOUT_FILENO)
+        : fd(fd), length(0)
+    {
+    }
+
+    output_buffer_t& operator<<(char c)
+    {
+        reserve(1);
+        buffer[length++] = c;
+        return *this;
+    }
+
+    output_buffer_t& operator<<(const char* text)
+    {
+        append(text, std::strlen(text));
+        return *this;
+    }
+
+    output_buffer_t& operator<<(const std::string& text)
+    {
+        append(text.data(), text.size());
+        return *this;
+    }
+
+    output_buffer_t& operator<<(const position_t& position)
+    {
+        return (*this << position.x << ' ' << position.y);
+    }
+
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    output_buffer_t& operator<<(T value)
+    {
+        const std::size_t MAX_DIGITS = 24;
+        char digits[MAX_DIGITS];
+        std::size_t count = 0;
+
+        bool negative = (value < 0);
+        unsigned long long int absolute = negative
+            ? static_cast<unsigned long long int>(-(value + 1)) + 1
+            : static_cast<unsigned long long int>(value);
+
+        do
+        {
+            digits[MAX_DIGITS - (++count)] = static_cast<char>('0' + absolute % 10);
+            absolute /= 10;
+        } while (absolute > 0);
+
+        if (negative)
+            digits[MAX_DIGITS - (++count)] = '-';
+
+        append(digits + MAX_DIGITS - count, count);
+        return *this;
+    }
+
+    void flush()
+    {
+        std::size_t written = 0;
+
+        while (fd >= 0 && written < length)
+        {
+            ssize_t result = ::write(fd, buffer.data() + written, length - written);
+            if (result <= 0)
+                break;
+
+            written += static_cast<std::size_t>(result);
+        }
+
+        clear();
+    }
+
+    void clear()
+    {
+        length = 0;
+    }
+
+    const char* data() const
+    {
+        return buffer.data();
+    }
+
+    std::size_t size() const
+    {
+        return length;
+    }
+
+
+private:
+    // Text longer than free space is copied in chunks, flushing full buffer in between
+    void append(const char* text, std::size_t count)
+    {
+        while (length + count > buffer.size())
+        {
+            std::size_t chunk = buffer.size() - length;
+            std::memcpy(buffer.data() + length, text, chunk);
+            length += chunk;
+            text += chunk;
+            count -= chunk;
+
+            make_room();
+        }
+
+        std::memcpy(buffer.data() + length, text, count);
+        length += count;
+    }
+
+    void reserve(std::size_t count)
+    {
+        if (length + count > buffer.size())
+            make_room();
+    }
+
+    void make_room()
+    {
+        if (fd < 0)
+            throw std::length_error("Output capture buffer overflow");
+
+        flush();
+    }
+
+
+private:
+    int fd;
+    std::size_t length;
+    std::array<char, 1 << 12> buffer;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+
+
+// Fixed-size storage of optional per-buster values, indexed by buster's index within own team
+// (see `game_data_t::get_buster_index`). Absent values read as default-constructed ones.
+
+template <typename value_type, std::size_t BUSTERS_COUNT>
+class per_buster_t
+{
+public:
+    void clear()
+    {
+        presence.reset();
+        values.fill(value_type());
+    }
+
+    std::size_t size() const
+    {
+        return presence.count();
+    }
+
+    bool contains(std::size_t index) const
+    {
+        return presence.test(index);
+    }
+
+    const value_type& get(std::size_t index) const
+    {
+        return values[index];
+    }
+
+    // Like `std::map::insert`, doesn't overwrite already present value
+    void insert(std::size_t index, const value_type& value)
+    {
+        if (!contains(index))
+            set(index, value);
+    }
+
+    void set(std::size_t index, const value_type& value)
+    {
+        presence.set(index);
+        values[index] = value;
+    }
+
+
+private:
+    std::bitset<BUSTERS_COUNT> presence;
+    std::array<value_type, BUSTERS_COUNT> values;
+};
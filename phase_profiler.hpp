@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+#include "allocation_counters.hpp"
+#include "hardware_counters.hpp"
+
+
+// Build with `-DPROFILE_PHASES=1` to compile phase timers and counters in, otherwise they compile to nothing.
+#ifndef PROFILE_PHASES
+#define PROFILE_PHASES 0
+#endif
+
+
+// Per-round latency of phases of the round (reading input, each tracking data step, scoring, ...) together with
+// per-round counters (tasks, scored pairs, ...). Every round's values are kept, and distribution over whole game
+// (p50, p99 and max) is reported at the end.
+//
+// With hardware counters compiled in (see `hardware_counters_t`), hardware events of every phase are summed
+// over whole game and reported as CSV.
+//
+// With allocation counting compiled in (see `allocation_counters_t`), heap allocations (count and bytes) of every
+// phase are kept per round and reported for every round, so that rounds which still allocate can be found.
+
+class phase_profiler_t
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    static const bool ENABLED = (PROFILE_PHASES != 0);
+    static const bool ANY_ENABLED = (ENABLED || hardware_counters_t::ENABLED || allocation_counters_t::ENABLED);
+    static const std::size_t EXPECTED_ROUNDS_COUNT = 250; // history is reserved up front, so recording doesn't allocate
+
+    enum class phase_t
+    {
+        ROUND,
+        PROCESS_ROUND_DATA,
+        READ_ROUND_DATA,
+        COMPUTE_APPEARED_GHOSTS,
+        COMPUTE_DISAPPEARED_GHOSTS,
+        COMPUTE_STUN_TRACKING_DATA,
+        COMPUTE_APPEARED_ENEMIES,
+        COMPUTE_DISAPPEARED_ENEMIES,
+        COMPUTE_BUSTERS_START_CARRYING_GHOSTS,
+        COMPUTE_BUSTERS_STOP_CARRYING_GHOSTS,
+        COMPUTE_LOST_GHOSTS,
+        ON_NEW_ROUND,
+        ASSIGN_TASKS,
+        SCORING,
+        SORTING,
+        SELECTION,
+        EXECUTE_ASSIGNMENTS,
+        WRITE_COMMANDS,
+    };
+
+    static const std::size_t PHASES_COUNT = 18;
+
+    enum class counter_t
+    {
+        TASKS,
+        SCORED_PAIRS,
+        PRUNED_PAIRS,
+        ASSIGNMENTS_CHOSEN,
+    };
+
+    static const std::size_t COUNTERS_COUNT = 4;
+
+
+public:
+    phase_profiler_t()
+        : current_durations(), current_counters(), events(), events_calls(), current_allocations()
+    {
+        if (ENABLED)
+        {
+            for (auto& values : durations)
+                values.reserve(EXPECTED_ROUNDS_COUNT);
+
+            for (auto& values : counters)
+                values.reserve(EXPECTED_ROUNDS_COUNT);
+        }
+
+        if (allocation_counters_t::ENABLED)
+            allocations.reserve(EXPECTED_ROUNDS_COUNT);
+    }
+
+    // Runs `callable` and adds its duration to given phase of current round
+    template <typename callable_type>
+    void measure(phase_t phase, callable_type callable)
+    {
+        if (!ANY_ENABLED)
+        {
+            callable();
+            return;
+        }
+
+        hardware_counters_t::values_t events_at_start;
+        if (hardware_counters_t::ENABLED)
+            events_at_start = hardware_counters.read_values();
+
+        allocation_counters_t::values_t allocations_at_start = allocation_counters_t::read_values();
+
+        clock_t::time_point start = clock_t::now();
+        callable();
+        current_durations[static_cast<std::size_t>(phase)] += clock_t::now() - start;
+
+        if (hardware_counters_t::ENABLED)
+        {
+            hardware_counters_t::values_t events_at_end = hardware_counters.read_values();
+
+            for (std::size_t i = 0; i < hardware_counters_t::EVENTS_COUNT; ++i)
+                events[static_cast<std::size_t>(phase)][i] += events_at_end[i] - events_at_start[i];
+
+            ++events_calls[static_cast<std::size_t>(phase)];
+        }
+
+        if (allocation_counters_t::ENABLED)
+        {
+            allocation_counters_t::values_t allocations_at_end = allocation_counters_t::read_values();
+            allocation_counters_t::values_t& current = current_allocations[static_cast<std::size_t>(phase)];
+
+            current.allocations += allocations_at_end.allocations - allocations_at_start.allocations;
+            current.bytes += allocations_at_end.bytes - allocations_at_start.bytes;
+        }
+    }
+
+    void count(counter_t counter, std::size_t value)
+    {
+        if (ENABLED)
+            current_counters[static_cast<std::size_t>(counter)] += value;
+    }
+
+    void end_round()
+    {
+        if (allocation_counters_t::ENABLED)
+        {
+            allocations.push_back(current_allocations);
+            current_allocations = allocations_t();
+        }
+
+        if (!ENABLED)
+            return;
+
+        for (std::size_t i = 0; i < PHASES_COUNT; ++i)
+        {
+            durations[i].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(current_durations[i]).count());
+            current_durations[i] = clock_t::duration::zero();
+        }
+
+        for (std::size_t i = 0; i < COUNTERS_COUNT; ++i)
+        {
+            counters[i].push_back(current_counters[i]);
+            current_counters[i] = 0;
+        }
+    }
+
+    void report(std::ostream& stream) const
+    {
+        report_latencies(stream);
+        report_hardware_events(stream);
+        report_allocations(stream);
+    }
+
+
+private:
+    void report_latencies(std::ostream& stream) const
+    {
+        if (!ENABLED)
+            return;
+
+        stream << std::left << std::setw(40) << "phase [us]" << std::right
+            << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+        for (std::size_t i = 0; i < PHASES_COUNT; ++i)
+        {
+            std::vector<std::int64_t> values = durations[i];
+            stream << std::left << std::setw(40) << PHASES_NAMES[i] << std::right << std::fixed << std::setprecision(1)
+                << std::setw(10) << percentile(values, 0.50) / 1000.0
+                << std::setw(10) << percentile(values, 0.99) / 1000.0
+                << std::setw(10) << percentile(values, 1.00) / 1000.0 << std::endl;
+        }
+
+        stream << std::left << std::setw(40) << "counter [per round]" << std::right
+            << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+        for (std::size_t i = 0; i < COUNTERS_COUNT; ++i)
+        {
+            std::vector<std::int64_t> values(std::begin(counters[i]), std::end(counters[i]));
+            stream << std::left << std::setw(40) << COUNTERS_NAMES[i] << std::right
+                << std::setw(10) << percentile(values, 0.50)
+                << std::setw(10) << percentile(values, 0.99)
+                << std::setw(10) << percentile(values, 1.00) << std::endl;
+        }
+    }
+
+    // One CSV line per phase: name, number of measured calls and sum of every event (empty if unavailable)
+    void report_hardware_events(std::ostream& stream) const
+    {
+        if (!hardware_counters_t::ENABLED)
+            return;
+
+        stream << "phase,calls";
+        for (std::size_t i = 0; i < hardware_counters_t::EVENTS_COUNT; ++i)
+            stream << "," << hardware_counters_t::get_name(static_cast<hardware_counters_t::event_t>(i));
+        stream << std::endl;
+
+        for (std::size_t phase = 0; phase < PHASES_COUNT; ++phase)
+        {
+            const char* name = PHASES_NAMES[phase];
+            while (*name == ' ')
+                ++name;
+
+            stream << name << "," << events_calls[phase];
+            for (std::size_t i = 0; i < hardware_counters_t::EVENTS_COUNT; ++i)
+            {
+                stream << ",";
+                if (hardware_counters.is_available(static_cast<hardware_counters_t::event_t>(i)))
+                    stream << events[phase][i];
+            }
+            stream << std::endl;
+        }
+    }
+
+    // One CSV line per round: round, allocations and bytes of whole round, followed by `phase:allocations:bytes`
+    // for every phase which allocated, then number of rounds without any allocation
+    void report_allocations(std::ostream& stream) const
+    {
+        if (!allocation_counters_t::ENABLED)
+            return;
+
+        std::size_t rounds_without_allocations = 0;
+
+        stream << "round,allocations,bytes,phases" << std::endl;
+        for (std::size_t round = 0; round < allocations.size(); ++round)
+        {
+            const allocation_counters_t::values_t& total = allocations[round][static_cast<std::size_t>(phase_t::ROUND)];
+            if (total.allocations == 0)
+                ++rounds_without_allocations;
+
+            stream << round << "," << total.allocations << "," << total.bytes << ",";
+            for (std::size_t phase = 0; phase < PHASES_COUNT; ++phase)
+            {
+                const allocation_counters_t::values_t& values = allocations[round][phase];
+                if (phase == static_cast<std::size_t>(phase_t::ROUND) || values.allocations == 0)
+                    continue;
+
+                const char* name = PHASES_NAMES[phase];
+                while (*name == ' ')
+                    ++name;
+
+                stream << " " << name << ":" << values.allocations << ":" << values.bytes;
+            }
+            stream << std::endl;
+        }
+
+        stream << "rounds without allocations: " << rounds_without_allocations << "/" << allocations.size() << std::endl;
+    }
+
+    // Nearest-rank percentile, sorts given values
+    static std::int64_t percentile(std::vector<std::int64_t>& values, double fraction)
+    {
+        if (values.empty())
+            return 0;
+
+        std::sort(std::begin(values), std::end(values));
+
+        std::size_t rank = static_cast<std::size_t>(fraction * values.size() + 0.999999);
+        return values[std::min(std::max<std::size_t>(rank, 1), values.size()) - 1];
+    }
+
+
+private:
+    static const char* const PHASES_NAMES[PHASES_COUNT];
+    static const char* const COUNTERS_NAMES[COUNTERS_COUNT];
+
+    std::array<clock_t::duration, PHASES_COUNT> current_durations;
+    std::array<std::size_t, COUNTERS_COUNT> current_counters;
+    std::array<std::vector<std::int64_t>, PHASES_COUNT> durations; // per round, in nanoseconds
+    std::array<std::vector<std::size_t>, COUNTERS_COUNT> counters; // per round
+
+    hardware_counters_t hardware_counters;
+    std::array<hardware_counters_t::values_t, PHASES_COUNT> events; // per phase, summed over whole game
+    std::array<std::size_t, PHASES_COUNT> events_calls; // per phase
+
+    using allocations_t = std::array<allocation_counters_t::values_t, PHASES_COUNT>;
+    allocations_t current_allocations; // per phase
+    std::vector<allocations_t> allocations; // per round
+};
+
+const char* const phase_profiler_t::PHASES_NAMES[PHASES_COUNT] = {
+    "round",
+    "process_round_data",
+    "  read_round_data",
+    "  compute_appeared_ghosts",
+    "  compute_disappeared_ghosts",
+    "  compute_stun_tracking_data",
+    "  compute_appeared_enemies",
+    "  compute_disappeared_enemies",
+    "  compute_busters_start_carrying_ghosts",
+    "  compute_busters_stop_carrying_ghosts",
+    "  compute_lost_ghosts",
+    "on_new_round",
+    "assign_tasks",
+    "  scoring",
+    "  sorting",
+    "  selection",
+    "execute_assignments",
+    "write_commands",
+};
+
+const char* const phase_profiler_t::COUNTERS_NAMES[COUNTERS_COUNT] = {
+    "tasks",
+    "scored pairs",
+    "pruned pairs",
+    "assignments chosen",
+};
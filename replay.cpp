@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+
+#include "codebusters_player.hpp"
+
+
+// Usage: replay FILE [--output] [--round N]
+//        replay --corpus DIR [--worst N] [--max-us N] [--p99-us N]
+//
+// Feeds game recorded with `codebusters --record FILE` back through the bot's `play()` loop from memory.
+// Bot's commands are discarded unless `--output` is given, in which case they are written to stdout.
+// With `--round` game is replayed only up to given round (e.g. the slowest one reported by `--corpus`), whose
+// latency is reported.
+//
+// With `--corpus` every file in DIR is replayed (in name order) with commands written to /dev/null, so that
+// watchdog and output run as on the judge, and latency of every round is measured. Reports every game's rounds,
+// total and slowest round, latency distribution over all rounds and `--worst` slowest rounds with their game
+// and round index. Exits with 2 if slowest round takes longer than `--max-us` or p99 is above `--p99-us`.
+
+namespace
+{
+    using latency_t = std::chrono::duration<double, std::micro>;
+
+    const round_num_t ALL_ROUNDS = std::numeric_limits<round_num_t>::max();
+
+    struct game_record_t
+    {
+        unsigned int random_seed;
+        std::string data; // raw input after the seed line
+    };
+
+    struct round_latency_t
+    {
+        std::size_t game;
+        round_num_t round;
+        latency_t latency;
+    };
+
+    bool load_record(const std::string& path, game_record_t& record)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        input_reader_t reader(content.data(), content.size());
+        record.random_seed = reader.read_integer<unsigned int>();
+
+        std::size_t seed_end = content.find('\n');
+        record.data = (seed_end == std::string::npos) ? std::string() : content.substr(seed_end + 1);
+        return true;
+    }
+
+    // Runs rounds of `codebusters_player_t::play()` timed, up to given number of rounds
+    struct timed_round_runner_t
+    {
+        using clock_t = std::chrono::steady_clock;
+
+        std::vector<latency_t>& latencies;
+        round_num_t rounds_limit;
+
+        template <typename round_type>
+        bool operator()(round_type round)
+        {
+            clock_t::time_point start = clock_t::now();
+            round();
+            latencies.push_back(clock_t::now() - start);
+
+            return (latencies.size() < rounds_limit);
+        }
+    };
+
+    template <count_t BUSTERS_COUNT>
+    void replay_rounds(const game_settings_t& settings, unsigned int random_seed, int output_fd, round_num_t rounds_limit,
+        std::vector<latency_t>& latencies)
+    {
+        codebusters_player_t<BUSTERS_COUNT> player(settings, random_seed, output_fd);
+        player.play(timed_round_runner_t { latencies, rounds_limit });
+    }
+
+    // Replays game from memory, returns latencies of its rounds
+    std::vector<latency_t> replay_game(const game_record_t& record, int output_fd, round_num_t rounds_limit)
+    {
+        std::vector<latency_t> latencies;
+
+        input_reader_t reader(record.data.data(), record.data.size());
+        input::use_reader(reader);
+
+        game_settings_t settings = input::read_game_settings();
+        switch (settings.busters_count)
+        {
+        case 2:
+            replay_rounds<2>(settings, record.random_seed, output_fd, rounds_limit, latencies);
+            break;
+        case 3:
+            replay_rounds<3>(settings, record.random_seed, output_fd, rounds_limit, latencies);
+            break;
+        case 4:
+            replay_rounds<4>(settings, record.random_seed, output_fd, rounds_limit, latencies);
+            break;
+        case 5:
+            replay_rounds<5>(settings, record.random_seed, output_fd, rounds_limit, latencies);
+            break;
+        default:
+            throw std::out_of_range("Unsupported number of busters per player");
+        }
+
+        input::use_default_reader();
+        return latencies;
+    }
+
+    std::vector<std::string> list_directory(const char* path)
+    {
+        std::vector<std::string> result;
+
+        DIR* directory = ::opendir(path);
+        if (!directory)
+            return result;
+
+        while (dirent* entry = ::readdir(directory))
+        {
+            if (entry->d_name[0] != '.')
+                result.push_back(std::string(path) + "/" + entry->d_name);
+        }
+
+        ::closedir(directory);
+        std::sort(result.begin(), result.end());
+
+        return result;
+    }
+
+    // Nearest-rank percentile of sorted latencies
+    latency_t get_percentile(const std::vector<latency_t>& sorted, double percentile)
+    {
+        if (sorted.empty())
+            return latency_t::zero();
+
+        std::size_t rank = static_cast<std::size_t>(percentile / 100.0 * sorted.size() + 0.999999);
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+
+    int benchmark_corpus(const char* directory_path, std::size_t worst_count, double max_us, double p99_us)
+    {
+        std::vector<std::string> paths = list_directory(directory_path);
+        if (paths.empty())
+        {
+            std::cerr << "No recorded games in: " << directory_path << std::endl;
+            return 1;
+        }
+
+        int null_fd = ::open("/dev/null", O_WRONLY);
+        if (null_fd < 0)
+        {
+            std::cerr << "Can't open /dev/null" << std::endl;
+            return 1;
+        }
+
+        std::vector<round_latency_t> rounds;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "# game rounds total_us mean_us max_us max_round" << std::endl;
+
+        for (std::size_t game = 0; game < paths.size(); ++game)
+        {
+            game_record_t record;
+            if (!load_record(paths[game], record))
+            {
+                std::cerr << "Can't open record file: " << paths[game] << std::endl;
+                return 1;
+            }
+
+            std::vector<latency_t> latencies = replay_game(record, null_fd, ALL_ROUNDS);
+
+            latency_t total = latency_t::zero();
+            std::size_t slowest = 0;
+            for (std::size_t round = 0; round < latencies.size(); ++round)
+            {
+                total += latencies[round];
+                if (latencies[round] > latencies[slowest])
+                    slowest = round;
+
+                rounds.push_back(round_latency_t { game, static_cast<round_num_t>(round), latencies[round] });
+            }
+
+            std::cout << paths[game] << ' ' << latencies.size() << ' ' << total.count() << ' '
+                << (latencies.empty() ? 0.0 : total.count() / latencies.size()) << ' '
+                << (latencies.empty() ? 0.0 : latencies[slowest].count()) << ' ' << slowest << std::endl;
+        }
+
+        ::close(null_fd);
+
+        std::vector<latency_t> sorted;
+        for (const round_latency_t& round : rounds)
+            sorted.push_back(round.latency);
+        std::sort(sorted.begin(), sorted.end());
+
+        const latency_t p99 = get_percentile(sorted, 99.0);
+        const latency_t max = sorted.empty() ? latency_t::zero() : sorted.back();
+
+        std::cout << "rounds " << sorted.size() << " p50_us " << get_percentile(sorted, 50.0).count()
+            << " p90_us " << get_percentile(sorted, 90.0).count() << " p99_us " << p99.count()
+            << " max_us " << max.count() << std::endl;
+
+        std::stable_sort(rounds.begin(), rounds.end(), [](const round_latency_t& a, const round_latency_t& b) {
+            return a.latency > b.latency;
+        });
+
+        for (std::size_t i = 0; i < std::min(worst_count, rounds.size()); ++i)
+        {
+            std::cout << "worst " << rounds[i].latency.count() << " us: replay " << paths[rounds[i].game]
+                << " --round " << rounds[i].round << std::endl;
+        }
+
+        bool exceeded = false;
+        if (max_us > 0.0 && max.count() > max_us)
+        {
+            std::cerr << "Slowest round " << max.count() << " us exceeds ceiling of " << max_us << " us" << std::endl;
+            exceeded = true;
+        }
+
+        if (p99_us > 0.0 && p99.count() > p99_us)
+        {
+            std::cerr << "p99 " << p99.count() << " us exceeds ceiling of " << p99_us << " us" << std::endl;
+            exceeded = true;
+        }
+
+        return exceeded ? 2 : 0;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " FILE [--output] [--round N]" << std::endl;
+        std::cerr << "       " << argv[0] << " --corpus DIR [--worst N] [--max-us N] [--p99-us N]" << std::endl;
+        return 1;
+    }
+
+    if (std::strcmp(argv[1], "--corpus") == 0)
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Missing corpus directory" << std::endl;
+            return 1;
+        }
+
+        std::size_t worst_count = 10;
+        double max_us = 0.0, p99_us = 0.0;
+
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            if (std::strcmp(argv[i], "--worst") == 0)
+                worst_count = std::strtoul(argv[i + 1], nullptr, 10);
+            else if (std::strcmp(argv[i], "--max-us") == 0)
+                max_us = std::strtod(argv[i + 1], nullptr);
+            else if (std::strcmp(argv[i], "--p99-us") == 0)
+                p99_us = std::strtod(argv[i + 1], nullptr);
+        }
+
+        return benchmark_corpus(argv[2], worst_count, max_us, p99_us);
+    }
+
+    bool write_output = false;
+    round_num_t last_round = ALL_ROUNDS;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--output") == 0)
+            write_output = true;
+        else if (std::strcmp(argv[i], "--round") == 0 && i + 1 < argc)
+            last_round = static_cast<round_num_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+
+    game_record_t record;
+    if (!load_record(argv[1], record))
+    {
+        std::cerr << "Can't open record file: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<latency_t> latencies = replay_game(record, write_output ? STDOUT_FILENO : -1,
+        (last_round == ALL_ROUNDS) ? ALL_ROUNDS : last_round + 1);
+
+    latency_t total = latency_t::zero();
+    for (const latency_t& latency : latencies)
+        total += latency;
+
+    std::cerr << "Replayed " << argv[1] << " in " << static_cast<long long int>(total.count()) << " us" << std::endl;
+
+    if (last_round != ALL_ROUNDS && last_round < latencies.size())
+        std::cerr << "Round " << last_round << " took " << latencies[last_round].count() << " us" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "entity.hpp"
+#include "types.hpp"
+
+
+// Cache of (task, buster) assignment scores kept across rounds.
+//
+// Rows are addressed by task registry handles, columns by buster indices. Every row and column remembers
+// inputs its scores were computed from; when those change (buster moved or changed state, task was replaced
+// or refreshed, target moved, ...) whole row or column is invalidated. Only invalidated cells need rescoring.
+// Rows depending on inputs which can't be compared cheaply (e.g. round number) are marked volatile
+// and never cached.
+
+template <std::size_t BUSTERS_COUNT>
+class score_cache_t
+{
+public:
+    // Everything score of a task depends on, apart from the buster
+    struct task_inputs_t
+    {
+        std::uint64_t task_version; // changes when task in given handle is replaced or modified
+        position_t target_position;
+        value_t target_value;
+        value_t points;
+        bool volatile_inputs;
+
+        bool operator==(const task_inputs_t& other) const
+        {
+            return (task_version == other.task_version &&
+                target_position == other.target_position &&
+                target_value == other.target_value &&
+                points == other.points &&
+                !volatile_inputs &&
+                !other.volatile_inputs);
+        }
+    };
+
+    // Everything score of a task depends on, apart from the task
+    struct buster_inputs_t
+    {
+        position_t position;
+        buster_t::state_t state;
+        value_t value;
+
+        bool operator==(const buster_inputs_t& other) const
+        {
+            return (position == other.position && state == other.state && value == other.value);
+        }
+    };
+
+
+private:
+    struct row_t
+    {
+        task_inputs_t inputs;
+        std::bitset<BUSTERS_COUNT> valid;
+        factor_t scores[BUSTERS_COUNT];
+    };
+
+
+public:
+    explicit score_cache_t(std::size_t rows_count)
+        : rows(rows_count), busters_valid(), hits_count(0), misses_count(0)
+    {
+    }
+
+    void update_buster(std::size_t buster_index, const buster_inputs_t& inputs)
+    {
+        if (busters_valid.test(buster_index) && busters[buster_index] == inputs)
+            return;
+
+        busters[buster_index] = inputs;
+        busters_valid.set(buster_index);
+
+        for (row_t& row : rows)
+            row.valid.reset(buster_index);
+    }
+
+    void update_task(std::size_t handle, const task_inputs_t& inputs)
+    {
+        row_t& row = rows[handle];
+
+        if (row.inputs == inputs)
+            return;
+
+        row.inputs = inputs;
+        row.valid.reset();
+    }
+
+    bool lookup(std::size_t handle, std::size_t buster_index, factor_t& score)
+    {
+        const row_t& row = rows[handle];
+
+        if (!row.valid.test(buster_index))
+        {
+            ++misses_count;
+            return false;
+        }
+
+        score = row.scores[buster_index];
+        ++hits_count;
+        return true;
+    }
+
+    void store(std::size_t handle, std::size_t buster_index, factor_t score)
+    {
+        row_t& row = rows[handle];
+
+        row.scores[buster_index] = score;
+        if (!row.inputs.volatile_inputs)
+            row.valid.set(buster_index);
+    }
+
+    std::size_t hits() const
+    {
+        return hits_count;
+    }
+
+    std::size_t misses() const
+    {
+        return misses_count;
+    }
+
+
+private:
+    std::vector<row_t> rows; // indexed by task handle
+    buster_inputs_t busters[BUSTERS_COUNT]; // indexed by buster index
+    std::bitset<BUSTERS_COUNT> busters_valid;
+    std::size_t hits_count;
+    std::size_t misses_count;
+};
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "codebusters_referee.hpp"
+#include "strategy_params.hpp"
+
+
+// Usage: simulate [--busters N] [--ghosts N] [--seed N] [--games N]
+//                 [--candidate NAME=VALUE]... [--baseline NAME=VALUE]... [--candidate-team N]
+//                 [--candidate-params FILE] [--baseline-params FILE]
+//
+// Plays games of the bot against itself in-process (see `codebusters_referee_t`), with consecutive seeds starting
+// from given one. Bot of `--candidate-team` (0 by default) plays with `--candidate` strategy parameters, the other
+// one with `--baseline` ones, so that games reported by `tournament` can be replayed. Parameters start from defaults,
+// `*-params` files and single overrides are applied in command line order.
+// Every game is written as `seed points_0 points_1 rounds`, followed by overall throughput.
+
+int main(int argc, char* argv[])
+{
+    count_t busters_count = 3;
+    count_t ghosts_count = 15;
+    unsigned int random_seed = DEFAULT_RANDOM_SEED;
+    std::size_t games_count = 1;
+    strategy_params_t candidate;
+    strategy_params_t baseline;
+    id_type candidate_team = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--busters") == 0)
+            busters_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--ghosts") == 0)
+            ghosts_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            random_seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--games") == 0)
+            games_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--candidate-team") == 0)
+            candidate_team = std::strtoul(argv[i + 1], nullptr, 10);
+        else if ((std::strcmp(argv[i], "--candidate-params") == 0 && !candidate.load(argv[i + 1])) ||
+            (std::strcmp(argv[i], "--baseline-params") == 0 && !baseline.load(argv[i + 1])))
+        {
+            std::cerr << "Can't load strategy parameters: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else if ((std::strcmp(argv[i], "--candidate") == 0 && !candidate.apply(argv[i + 1])) ||
+            (std::strcmp(argv[i], "--baseline") == 0 && !baseline.apply(argv[i + 1])))
+        {
+            std::cerr << "Unknown strategy parameter: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+    }
+
+    const strategy_params_t& params_0 = (candidate_team == 0) ? candidate : baseline;
+    const strategy_params_t& params_1 = (candidate_team == 0) ? baseline : candidate;
+
+    auto start = std::chrono::steady_clock::now();
+    round_num_t rounds_count = 0;
+
+    for (std::size_t game = 0; game < games_count; ++game)
+    {
+        unsigned int seed = random_seed + static_cast<unsigned int>(game);
+        match_result_t result = play_codebusters_match(busters_count, ghosts_count, seed, params_0, params_1);
+
+        std::cout << seed << ' ' << result.points[0] << ' ' << result.points[1] << ' ' << result.rounds << '\n';
+        rounds_count += result.rounds;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "Played " << games_count << " games (" << rounds_count << " rounds) in " << elapsed.count() << " s, "
+        << games_count / elapsed.count() << " games/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "types.hpp"
+
+
+// Uniform-grid bucketing of points on the map.
+//
+// Map is split into square cells of given size (chosen to match game ranges, so that range query touches only
+// neighbouring cells). Each cell keeps ids and positions of points inserted into it. Cells are cleared without
+// releasing their memory, so rebuilding index every round doesn't allocate once it's warmed up.
+//
+// Queries visit every point from cells overlapping query's bounding square; exact range predicate is left
+// to the caller.
+
+class spatial_index_t
+{
+public:
+    struct entry_t
+    {
+        id_type id;
+        position_t position;
+    };
+
+
+public:
+    spatial_index_t(position_t map_size, coord_t cell_size)
+        : cell_size(cell_size),
+        columns(map_size.x / cell_size + 1),
+        rows(map_size.y / cell_size + 1),
+        cells(columns * rows),
+        entries_count(0)
+    {
+    }
+
+    void clear()
+    {
+        for (auto& cell : cells)
+            cell.clear();
+
+        entries_count = 0;
+    }
+
+    void insert(id_type id, const position_t& position)
+    {
+        cells[cell_index(column_of(position.x), row_of(position.y))].push_back(entry_t { id, position });
+        ++entries_count;
+    }
+
+    // Removes entry inserted with given id and position (order of entries within the cell is not preserved)
+    void erase(id_type id, const position_t& position)
+    {
+        auto& cell = cells[cell_index(column_of(position.x), row_of(position.y))];
+
+        for (std::size_t i = 0; i < cell.size(); ++i)
+        {
+            if (cell[i].id == id)
+            {
+                cell[i] = cell.back();
+                cell.pop_back();
+                --entries_count;
+                return;
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return entries_count;
+    }
+
+    template <typename callback_type>
+    void for_each_near(const position_t& center, double range, callback_type callback) const
+    {
+        if (entries_count == 0)
+            return;
+
+        coord_t reach = static_cast<coord_t>(std::max(0.0, range)) + 1;
+
+        std::size_t first_column = column_of((center.x > reach) ? center.x - reach : 0);
+        std::size_t last_column = column_of(center.x + reach);
+        std::size_t first_row = row_of((center.y > reach) ? center.y - reach : 0);
+        std::size_t last_row = row_of(center.y + reach);
+
+        for (std::size_t row = first_row; row <= last_row; ++row)
+        {
+            for (std::size_t column = first_column; column <= last_column; ++column)
+            {
+                for (const entry_t& entry : cells[cell_index(column, row)])
+                    callback(entry);
+            }
+        }
+    }
+
+
+private:
+    std::size_t column_of(coord_t x) const
+    {
+        return std::min(static_cast<std::size_t>(x / cell_size), columns - 1);
+    }
+
+    std::size_t row_of(coord_t y) const
+    {
+        return std::min(static_cast<std::size_t>(y / cell_size), rows - 1);
+    }
+
+    std::size_t cell_index(std::size_t column, std::size_t row) const
+    {
+        return row * columns + column;
+    }
+
+
+private:
+    coord_t cell_size;
+    std::size_t columns;
+    std::size_t rows;
+    std::vector<std::vector<entry_t>> cells;
+    std::size_t entries_count;
+};
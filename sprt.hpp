@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+
+// Sequential probability ratio test of candidate against baseline from candidate's wins, draws and losses.
+//
+// H0: candidate is `elo0` Elo stronger than baseline, H1: it is `elo1` Elo stronger. Log-likelihood ratio uses
+// normal approximation of per-game score (generalized SPRT), H1 is accepted once it reaches log((1 - beta) / alpha)
+// and H0 once it drops to log(beta / (1 - alpha)), where `alpha` and `beta` are false positive and false negative
+// rates. Until then more games are needed.
+
+class sprt_t
+{
+public:
+    enum class decision_t
+    {
+        UNDECIDED,
+        ACCEPT_H0, // candidate rejected
+        ACCEPT_H1, // candidate accepted
+    };
+
+
+public:
+    sprt_t(double elo0, double elo1, double alpha, double beta)
+        : score0(get_expected_score(elo0)),
+        score1(get_expected_score(elo1)),
+        lower_bound(std::log(beta / (1.0 - alpha))),
+        upper_bound(std::log((1.0 - beta) / alpha))
+    {
+    }
+
+    double get_llr(std::size_t wins, std::size_t draws, std::size_t losses) const
+    {
+        const double games = static_cast<double>(wins + draws + losses);
+        if (games == 0.0)
+            return 0.0;
+
+        const double score = (wins + 0.5 * draws) / games;
+        const double variance = (wins * (1.0 - score) * (1.0 - score) + draws * (0.5 - score) * (0.5 - score) + losses * score * score) / games;
+
+        // All games with the same result tell nothing about variance yet
+        if (variance <= 0.0)
+            return 0.0;
+
+        return games * (score1 - score0) * (2.0 * score - score0 - score1) / (2.0 * variance);
+    }
+
+    decision_t test(std::size_t wins, std::size_t draws, std::size_t losses) const
+    {
+        const double llr = get_llr(wins, draws, losses);
+
+        if (llr >= upper_bound)
+            return decision_t::ACCEPT_H1;
+        else if (llr <= lower_bound)
+            return decision_t::ACCEPT_H0;
+        else
+            return decision_t::UNDECIDED;
+    }
+
+    double get_lower_bound() const
+    {
+        return lower_bound;
+    }
+
+    double get_upper_bound() const
+    {
+        return upper_bound;
+    }
+
+
+private:
+    // Expected score of player stronger by given Elo difference
+    static double get_expected_score(double elo)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+
+private:
+    const double score0;
+    const double score1;
+    const double lower_bound;
+    const double upper_bound;
+};
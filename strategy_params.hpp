@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "types.hpp"
+
+
+// Tunable parameters of bot's strategy. Defaults are the values bot plays with; any parameter can be overridden
+// by name (e.g. `bust_moves_weight=3.5`) or loaded from file, so that candidate strategies can be compared
+// in self-play and tuned automatically.
+//
+// File has one `name value` (or `name=value`) per line, empty lines and lines starting with `#` are skipped,
+// parameters not listed keep their defaults.
+
+struct strategy_params_t
+{
+    // EXPLORE task factors (the higher, the less attractive)
+    factor_t explore_factor = 50.0; // random locations, expensive since most data comes from initial radar move
+    factor_t out_of_scope_ghost_factor = 12.0; // where ghost was seen last
+    factor_t weak_out_of_scope_ghost_multiplier = 0.7; // ghost with stamina below 5
+    factor_t medium_out_of_scope_ghost_multiplier = 0.9; // ghost with stamina below 16
+    factor_t projected_ghost_factor = 18.0; // ghost's mirrored position
+    factor_t explore_conflict_moves = 1.5; // explorations closer than that many moves aren't chosen together
+
+    // BUST: min(stamina, cap) / ceil((points + 0.1) / divisor) + moves * weight
+    factor_t bust_stamina_cap = 30.0;
+    factor_t bust_points_divisor = 4.0;
+    factor_t bust_moves_weight = 4.0;
+
+    // STUN thresholds
+    factor_t stun_max_enemy_stunned_timeout = 3.0; // enemy stunned for longer isn't stunned at all
+    factor_t restun_max_enemy_stunned_timeout = 3.0; // stunned enemy is stunned again when its stun wears off sooner
+    factor_t stun_max_busted_ghost_stamina = 10.0; // busting enemy is stunned when its ghost has less stamina left
+
+    // STUN scores (when not in range right now), lower is preferred
+    factor_t stun_carrier_score = 0.11;
+    factor_t stun_busting_score = 0.12;
+    factor_t restun_score = 0.13;
+
+    // COVER: moves to carrier * weight + carrier's moves to base * weight
+    factor_t cover_moves_to_carrier_weight = 15.0;
+    factor_t cover_moves_to_base_weight = 20.0;
+
+    // EJECT to friend closer to base
+    factor_t eject_friend_distance = 4320.0; // 1760 + 1760 + 800
+    factor_t eject_min_moves_saved = 2.0; // friend has to be more than that many moves closer to base
+    factor_t eject_min_busting_stamina = 6.0; // busting friend qualifies when its ghost has at least that stamina
+    factor_t eject_max_stunned_timeout = 2.0; // stunned friend qualifies when its stun wears off that soon
+    factor_t eject_target_max_stunned_timeout = 1.0; // -||-, when choosing which friend to eject to
+
+
+    static const std::size_t PARAMS_COUNT = 22;
+
+    struct param_t
+    {
+        const char* name;
+        factor_t strategy_params_t::* member;
+    };
+
+    static const std::array<param_t, PARAMS_COUNT>& get_params()
+    {
+        static const std::array<param_t, PARAMS_COUNT> params
+        {
+            {
+                { "explore_factor", &strategy_params_t::explore_factor },
+                { "out_of_scope_ghost_factor", &strategy_params_t::out_of_scope_ghost_factor },
+                { "weak_out_of_scope_ghost_multiplier", &strategy_params_t::weak_out_of_scope_ghost_multiplier },
+                { "medium_out_of_scope_ghost_multiplier", &strategy_params_t::medium_out_of_scope_ghost_multiplier },
+                { "projected_ghost_factor", &strategy_params_t::projected_ghost_factor },
+                { "explore_conflict_moves", &strategy_params_t::explore_conflict_moves },
+                { "bust_stamina_cap", &strategy_params_t::bust_stamina_cap },
+                { "bust_points_divisor", &strategy_params_t::bust_points_divisor },
+                { "bust_moves_weight", &strategy_params_t::bust_moves_weight },
+                { "stun_max_enemy_stunned_timeout", &strategy_params_t::stun_max_enemy_stunned_timeout },
+                { "restun_max_enemy_stunned_timeout", &strategy_params_t::restun_max_enemy_stunned_timeout },
+                { "stun_max_busted_ghost_stamina", &strategy_params_t::stun_max_busted_ghost_stamina },
+                { "stun_carrier_score", &strategy_params_t::stun_carrier_score },
+                { "stun_busting_score", &strategy_params_t::stun_busting_score },
+                { "restun_score", &strategy_params_t::restun_score },
+                { "cover_moves_to_carrier_weight", &strategy_params_t::cover_moves_to_carrier_weight },
+                { "cover_moves_to_base_weight", &strategy_params_t::cover_moves_to_base_weight },
+                { "eject_friend_distance", &strategy_params_t::eject_friend_distance },
+                { "eject_min_moves_saved", &strategy_params_t::eject_min_moves_saved },
+                { "eject_min_busting_stamina", &strategy_params_t::eject_min_busting_stamina },
+                { "eject_max_stunned_timeout", &strategy_params_t::eject_max_stunned_timeout },
+                { "eject_target_max_stunned_timeout", &strategy_params_t::eject_target_max_stunned_timeout },
+            }
+        };
+
+        return params;
+    }
+
+    // Sets parameter of given name, returns `false` if there is no such parameter
+    bool set(const std::string& name, factor_t value)
+    {
+        for (const param_t& param : get_params())
+        {
+            if (name == param.name)
+            {
+                this->*param.member = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Applies `name=value` override, returns `false` if it's malformed or there is no such parameter
+    bool apply(const char* assignment)
+    {
+        const char* separator = std::strchr(assignment, '=');
+        if (!separator)
+            return false;
+
+        char* end = nullptr;
+        factor_t value = std::strtod(separator + 1, &end);
+        if (end == separator + 1 || *end != '\0')
+            return false;
+
+        return set(std::string(assignment, separator), value);
+    }
+
+    // Loads parameters listed in given file, returns `false` if it can't be read or has malformed or unknown entries
+    bool load(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::replace(std::begin(line), std::end(line), '=', ' ');
+
+            std::istringstream stream(line);
+            std::string name;
+            factor_t value;
+
+            if (!(stream >> name >> value) || !set(name, value))
+                return false;
+        }
+
+        return true;
+    }
+
+    // Writes all parameters in file format
+    void save(std::ostream& stream) const
+    {
+        for (const param_t& param : get_params())
+            stream << param.name << ' ' << this->*param.member << '\n';
+    }
+};
+
+const std::size_t strategy_params_t::PARAMS_COUNT;
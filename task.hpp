@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #include "types.hpp"
 
 
@@ -28,6 +30,8 @@ public:
         RADAR,
     };
 
+    static const std::size_t TYPES_COUNT = 6;
+
     type_t type;
     id_type id; // for: bust, stun, cover
     position_t position; // for: explore
@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "distance_kernels.hpp"
+#include "spatial_index.hpp"
+#include "task.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+
+// Registry of all currently available tasks.
+//
+// Tasks live in slots addressed by stable handles (freed slots are reused) and are linked in insertion order,
+// so iteration order is the same as with plain list of tasks. Insertion and removal of a task are O(1):
+// - BUST, STUN and COVER tasks are found through hash index by (type, id),
+// - EXPLORE tasks are found through spatial index of their positions,
+// - number of tasks of each type is kept as a counter.
+//
+// Besides insertion order, handles of tasks are partitioned by type into contiguous arrays (unordered, removal
+// swaps last element in), so that tasks of one type can be scored in one batch. Positions and factors of EXPLORE
+// tasks are kept in the same order as struct-of-arrays for batched distance kernels.
+//
+// Registry is a bounded pool, so that per-round scoring cost of all tasks stays bounded during whole game:
+// - tasks are deduplicated: inserting task with the same (type, id), or EXPLORE task close to existing one,
+//   only refreshes existing task (EXPLORE keeps lower, i.e. more attractive, factor),
+// - when pool is full, the oldest EXPLORE task is evicted to make room for the new one,
+// - stale EXPLORE tasks can be aged out with `erase_explore_older_than`.
+
+class task_registry_t
+{
+public:
+    using handle_t = std::size_t;
+
+    static const handle_t INVALID_HANDLE = std::numeric_limits<handle_t>::max();
+
+
+private:
+    struct slot_t
+    {
+        task_t task;
+        round_num_t round; // when task was inserted (or last refreshed by duplicate)
+        std::uint64_t version; // unique among all tasks ever held by registry, changes when task is modified
+        std::size_t type_index; // index within handles of its type
+        handle_t previous;
+        handle_t next;
+    };
+
+
+public:
+    struct occupancy_t
+    {
+        std::size_t size;
+        std::size_t capacity;
+        std::size_t peak_size;
+        std::array<count_t, task_t::TYPES_COUNT> counts; // per task type
+        std::size_t deduplicated; // total number of inserts merged into existing tasks
+        std::size_t evicted; // total number of EXPLORE tasks evicted by full pool
+        std::size_t expired; // total number of EXPLORE tasks aged out
+    };
+
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = task_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const task_t*;
+        using reference = const task_t&;
+
+        const_iterator(const std::vector<slot_t>* slots, handle_t handle)
+            : slots(slots), current(handle)
+        {
+        }
+
+        const task_t& operator*() const
+        {
+            return (*slots)[current].task;
+        }
+
+        const task_t* operator->() const
+        {
+            return &(*slots)[current].task;
+        }
+
+        const_iterator& operator++()
+        {
+            current = (*slots)[current].next;
+            return *this;
+        }
+
+        handle_t handle() const
+        {
+            return current;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return (current == other.current);
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return (current != other.current);
+        }
+
+
+    private:
+        const std::vector<slot_t>* slots;
+        handle_t current;
+    };
+
+
+public:
+    task_registry_t(position_t map_size, coord_t explore_cell_size, std::size_t capacity, double explore_merge_distance)
+        : first(INVALID_HANDLE),
+        last(INVALID_HANDLE),
+        tasks_count(0),
+        next_version(0),
+        capacity(capacity),
+        explore_merge_distance(explore_merge_distance),
+        explore_index(map_size, explore_cell_size),
+        peak_size(0),
+        deduplicated(0),
+        evicted(0),
+        expired(0)
+    {
+        counts.fill(0);
+        slots.reserve(capacity);
+        free_handles.reserve(capacity);
+        explore_positions.xs.reserve(capacity);
+        explore_positions.ys.reserve(capacity);
+        explore_factors.reserve(capacity);
+    }
+
+    // Returns handle of inserted task, handle of existing task it was merged into or INVALID_HANDLE
+    // if pool is full of tasks which can't be evicted
+    handle_t insert(const task_t& task, round_num_t round)
+    {
+        handle_t duplicate = find_duplicate(task);
+        if (duplicate != INVALID_HANDLE)
+        {
+            slot_t& slot = slots[duplicate];
+            slot.round = round;
+            if (task.type == task_t::type_t::EXPLORE && task.factor < slot.task.factor)
+            {
+                slot.task.factor = task.factor;
+                slot.version = next_version++;
+                explore_factors[slot.type_index] = task.factor;
+            }
+
+            ++deduplicated;
+            return duplicate;
+        }
+
+        if (tasks_count >= capacity && !evict_oldest_explore())
+            return INVALID_HANDLE;
+
+        handle_t handle;
+
+        if (free_handles.empty())
+        {
+            handle = slots.size();
+            slots.push_back(slot_t { task, round, next_version++, handles_by_type[static_cast<std::size_t>(task.type)].size(), last, INVALID_HANDLE });
+        }
+        else
+        {
+            handle = free_handles.back();
+            free_handles.pop_back();
+            slots[handle] = slot_t { task, round, next_version++, handles_by_type[static_cast<std::size_t>(task.type)].size(), last, INVALID_HANDLE };
+        }
+
+        if (last != INVALID_HANDLE)
+            slots[last].next = handle;
+        else
+            first = handle;
+        last = handle;
+
+        if (task.type == task_t::type_t::EXPLORE)
+        {
+            explore_index.insert(handle, task.position);
+            explore_positions.push_back(task.position);
+            explore_factors.push_back(task.factor);
+        }
+        else
+        {
+            by_key.insert({ key_of(task.type, task.id), handle });
+        }
+
+        handles_by_type[static_cast<std::size_t>(task.type)].push_back(handle);
+        ++counts[static_cast<std::size_t>(task.type)];
+        ++tasks_count;
+        peak_size = std::max(peak_size, tasks_count);
+
+        return handle;
+    }
+
+    void erase(handle_t handle)
+    {
+        slot_t& slot = slots[handle];
+
+        erase_from_type_partition(slot);
+
+        if (slot.task.type == task_t::type_t::EXPLORE)
+        {
+            explore_index.erase(handle, slot.task.position);
+        }
+        else
+        {
+            auto range = by_key.equal_range(key_of(slot.task.type, slot.task.id));
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == handle)
+                {
+                    by_key.erase(it);
+                    break;
+                }
+            }
+        }
+
+        if (slot.previous != INVALID_HANDLE)
+            slots[slot.previous].next = slot.next;
+        else
+            first = slot.next;
+
+        if (slot.next != INVALID_HANDLE)
+            slots[slot.next].previous = slot.previous;
+        else
+            last = slot.previous;
+
+        --counts[static_cast<std::size_t>(slot.task.type)];
+        --tasks_count;
+
+        free_handles.push_back(handle);
+    }
+
+    // Removes all tasks of given type (BUST, STUN or COVER) with given id
+    void erase(task_t::type_t type, id_type id)
+    {
+        auto range = by_key.equal_range(key_of(type, id));
+
+        found_handles.clear();
+        for (auto it = range.first; it != range.second; ++it)
+            found_handles.push_back(it->second);
+
+        for (handle_t handle : found_handles)
+            erase(handle);
+    }
+
+    // Removes all EXPLORE tasks within given distance from position
+    void erase_explore_near(const position_t& position, double distance)
+    {
+        found_handles.clear();
+        explore_index.for_each_near(position, distance, [this, &position, distance](const spatial_index_t::entry_t& entry) {
+            if (is_within_range(entry.position, position, distance))
+                found_handles.push_back(entry.id);
+        });
+
+        for (handle_t handle : found_handles)
+            erase(handle);
+    }
+
+    // Removes all EXPLORE tasks inserted (or refreshed) before given round
+    void erase_explore_older_than(round_num_t round)
+    {
+        // Refreshing duplicate doesn't move task in insertion order, so all tasks need to be checked
+        handle_t handle = first;
+        while (handle != INVALID_HANDLE)
+        {
+            handle_t next = slots[handle].next;
+
+            if (slots[handle].task.type == task_t::type_t::EXPLORE && slots[handle].round < round)
+            {
+                erase(handle);
+                ++expired;
+            }
+
+            handle = next;
+        }
+    }
+
+    const task_t& get(handle_t handle) const
+    {
+        return slots[handle].task;
+    }
+
+    // Handles of all tasks of given type, in no particular order
+    const std::vector<handle_t>& get_handles_of_type(task_t::type_t type) const
+    {
+        return handles_by_type[static_cast<std::size_t>(type)];
+    }
+
+    // Positions and factors of EXPLORE tasks, in the same order as their handles
+    const point_batch_t& get_explore_positions() const
+    {
+        return explore_positions;
+    }
+
+    const std::vector<factor_t>& get_explore_factors() const
+    {
+        return explore_factors;
+    }
+
+    std::uint64_t version(handle_t handle) const
+    {
+        return slots[handle].version;
+    }
+
+    // Handles are always lower than capacity
+    std::size_t get_capacity() const
+    {
+        return capacity;
+    }
+
+    count_t count(task_t::type_t type) const
+    {
+        return counts[static_cast<std::size_t>(type)];
+    }
+
+    std::size_t size() const
+    {
+        return tasks_count;
+    }
+
+    occupancy_t occupancy() const
+    {
+        return occupancy_t { tasks_count, capacity, peak_size, counts, deduplicated, evicted, expired };
+    }
+
+    const_iterator begin() const
+    {
+        return { &slots, first };
+    }
+
+    const_iterator end() const
+    {
+        return { &slots, INVALID_HANDLE };
+    }
+
+
+private:
+    handle_t find_duplicate(const task_t& task) const
+    {
+        if (task.type != task_t::type_t::EXPLORE)
+        {
+            auto it = by_key.find(key_of(task.type, task.id));
+            return (it != by_key.end()) ? it->second : INVALID_HANDLE;
+        }
+
+        handle_t result = INVALID_HANDLE;
+        explore_index.for_each_near(task.position, explore_merge_distance, [this, &task, &result](const spatial_index_t::entry_t& entry) {
+            if (result == INVALID_HANDLE && is_within_range(entry.position, task.position, explore_merge_distance))
+                result = entry.id;
+        });
+
+        return result;
+    }
+
+    // Swaps last task of the same type into place of removed one
+    void erase_from_type_partition(const slot_t& slot)
+    {
+        std::vector<handle_t>& handles = handles_by_type[static_cast<std::size_t>(slot.task.type)];
+        std::size_t index = slot.type_index;
+
+        handles[index] = handles.back();
+        slots[handles[index]].type_index = index;
+        handles.pop_back();
+
+        if (slot.task.type == task_t::type_t::EXPLORE)
+        {
+            explore_positions.xs[index] = explore_positions.xs.back();
+            explore_positions.ys[index] = explore_positions.ys.back();
+            explore_factors[index] = explore_factors.back();
+
+            explore_positions.xs.pop_back();
+            explore_positions.ys.pop_back();
+            explore_factors.pop_back();
+        }
+    }
+
+    bool evict_oldest_explore()
+    {
+        for (handle_t handle = first; handle != INVALID_HANDLE; handle = slots[handle].next)
+        {
+            if (slots[handle].task.type == task_t::type_t::EXPLORE)
+            {
+                erase(handle);
+                ++evicted;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static std::uint64_t key_of(task_t::type_t type, id_type id)
+    {
+        return (static_cast<std::uint64_t>(type) << 32) | static_cast<std::uint64_t>(id);
+    }
+
+
+private:
+    std::vector<slot_t> slots;
+    std::vector<handle_t> free_handles;
+    handle_t first; // first task in insertion order
+    handle_t last; // last task in insertion order
+    std::size_t tasks_count;
+    std::uint64_t next_version;
+    std::size_t capacity; // not const, so that registry can be copy-assigned (e.g. restored between benchmark runs)
+    double explore_merge_distance; // EXPLORE tasks closer than that are considered duplicates
+
+    std::unordered_multimap<std::uint64_t, handle_t> by_key; // BUST, STUN and COVER tasks by (type, id)
+    spatial_index_t explore_index; // EXPLORE tasks by position
+    std::array<count_t, task_t::TYPES_COUNT> counts; // number of tasks of each type
+    std::array<std::vector<handle_t>, task_t::TYPES_COUNT> handles_by_type;
+    point_batch_t explore_positions; // for: EXPLORE tasks, indexed like their handles
+    std::vector<factor_t> explore_factors;
+
+    std::vector<handle_t> found_handles; // scratch buffer of tasks to remove
+
+    std::size_t peak_size;
+    std::size_t deduplicated;
+    std::size_t evicted;
+    std::size_t expired;
+};
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "codebusters_referee.hpp"
+#include "command_line.hpp"
+#include "sprt.hpp"
+#include "strategy_params.hpp"
+#include "work_stealing_pool.hpp"
+
+
+// Usage: tournament [--busters 2,3,4,5] [--ghosts 8,15,28] [--games N] [--seed N] [--threads N]
+//                   [--candidate NAME=VALUE]... [--baseline NAME=VALUE]...
+//                   [--candidate-params FILE] [--baseline-params FILE]
+//                   [--elo0 X] [--elo1 X] [--alpha X] [--beta X] [--outliers N] [--log FILE]
+//
+// Plays candidate strategy (`--candidate` strategy parameters) against baseline (`--baseline` ones) in every
+// config (number of busters and ghosts), at most `--games` games per config. Parameters start from defaults,
+// `*-params` files and single overrides are applied in command line order. Every seed is played twice with
+// sides swapped. Games are spread over all cores and every config stops early once SPRT decides it.
+//
+// Writes one summary line per config, followed by seeds of games which candidate lost and won by most points
+// (replayable with `simulate`). With `--log` every played game is written to FILE.
+
+namespace
+{
+    struct game_record_t
+    {
+        bool played;
+        unsigned int seed;
+        id_type candidate_team;
+        count_t candidate_points;
+        count_t baseline_points;
+        round_num_t rounds;
+
+        long long int get_points_difference() const
+        {
+            return static_cast<long long int>(candidate_points) - static_cast<long long int>(baseline_points);
+        }
+    };
+
+    // Results of one config, updated concurrently by all workers
+    struct config_t
+    {
+        count_t busters_count;
+        count_t ghosts_count;
+
+        std::atomic<std::size_t> wins;
+        std::atomic<std::size_t> draws;
+        std::atomic<std::size_t> losses;
+        std::atomic<long long int> points_difference; // candidate's points minus baseline's, summed over games
+        std::atomic<sprt_t::decision_t> decision;
+
+        std::vector<game_record_t> games; // every slot written by single job
+    };
+
+    void play_pair(config_t& config, std::size_t pair, unsigned int seed, const sprt_t& sprt,
+        const strategy_params_t& candidate, const strategy_params_t& baseline)
+    {
+        if (config.decision.load(std::memory_order_relaxed) != sprt_t::decision_t::UNDECIDED)
+            return; // already decided, nothing to gain from more games
+
+        for (id_type candidate_team = 0; candidate_team < 2; ++candidate_team)
+        {
+            match_result_t result = (candidate_team == 0)
+                ? play_codebusters_match(config.busters_count, config.ghosts_count, seed, candidate, baseline)
+                : play_codebusters_match(config.busters_count, config.ghosts_count, seed, baseline, candidate);
+
+            game_record_t& record = config.games[2 * pair + candidate_team];
+            record = game_record_t { true, seed, candidate_team, result.points[candidate_team], result.points[1 - candidate_team], result.rounds };
+
+            long long int difference = record.get_points_difference();
+            if (difference > 0)
+                config.wins.fetch_add(1, std::memory_order_relaxed);
+            else if (difference < 0)
+                config.losses.fetch_add(1, std::memory_order_relaxed);
+            else
+                config.draws.fetch_add(1, std::memory_order_relaxed);
+
+            config.points_difference.fetch_add(difference, std::memory_order_relaxed);
+        }
+
+        sprt_t::decision_t decision = sprt.test(config.wins.load(), config.draws.load(), config.losses.load());
+        sprt_t::decision_t undecided = sprt_t::decision_t::UNDECIDED;
+
+        if (decision != sprt_t::decision_t::UNDECIDED)
+            config.decision.compare_exchange_strong(undecided, decision);
+    }
+
+    const char* get_decision_name(sprt_t::decision_t decision)
+    {
+        switch (decision)
+        {
+        case sprt_t::decision_t::ACCEPT_H0:
+            return "rejected";
+        case sprt_t::decision_t::ACCEPT_H1:
+            return "accepted";
+        default:
+            return "undecided";
+        }
+    }
+
+    void report_outliers(const config_t& config, std::size_t outliers_count)
+    {
+        std::vector<const game_record_t*> played;
+        for (const game_record_t& record : config.games)
+        {
+            if (record.played)
+                played.push_back(&record);
+        }
+
+        std::sort(played.begin(), played.end(), [](const game_record_t* a, const game_record_t* b) {
+            return (a->get_points_difference() < b->get_points_difference()) ||
+                (a->get_points_difference() == b->get_points_difference() && a->seed < b->seed);
+        });
+
+        std::size_t count = std::min(outliers_count, played.size());
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const game_record_t& lost = *played[i];
+            std::cout << "  lost by " << -lost.get_points_difference() << ": --seed " << lost.seed << " --candidate-team " << lost.candidate_team << std::endl;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const game_record_t& won = *played[played.size() - 1 - i];
+            std::cout << "  won by " << won.get_points_difference() << ": --seed " << won.seed << " --candidate-team " << won.candidate_team << std::endl;
+        }
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::size_t> busters_counts { 2, 3, 4, 5 };
+    std::vector<std::size_t> ghosts_counts { 8, 15, 28 };
+    std::size_t max_games = 1000;
+    unsigned int random_seed = DEFAULT_RANDOM_SEED;
+    std::size_t threads_count = std::max(1u, std::thread::hardware_concurrency());
+    strategy_params_t candidate;
+    strategy_params_t baseline;
+    double elo0 = 0.0, elo1 = 5.0, alpha = 0.05, beta = 0.05;
+    std::size_t outliers_count = 3;
+    const char* log_path = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if ((std::strcmp(argv[i], "--busters") == 0 && !parse_list(argv[i + 1], busters_counts)) ||
+            (std::strcmp(argv[i], "--ghosts") == 0 && !parse_list(argv[i + 1], ghosts_counts)))
+        {
+            std::cerr << "Invalid list of numbers: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else if (std::strcmp(argv[i], "--games") == 0)
+            max_games = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            random_seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            threads_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--elo0") == 0)
+            elo0 = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--elo1") == 0)
+            elo1 = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--alpha") == 0)
+            alpha = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--beta") == 0)
+            beta = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--outliers") == 0)
+            outliers_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--log") == 0)
+            log_path = argv[i + 1];
+        else if ((std::strcmp(argv[i], "--candidate-params") == 0 && !candidate.load(argv[i + 1])) ||
+            (std::strcmp(argv[i], "--baseline-params") == 0 && !baseline.load(argv[i + 1])))
+        {
+            std::cerr << "Can't load strategy parameters: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else if ((std::strcmp(argv[i], "--candidate") == 0 && !candidate.apply(argv[i + 1])) ||
+            (std::strcmp(argv[i], "--baseline") == 0 && !baseline.apply(argv[i + 1])))
+        {
+            std::cerr << "Unknown strategy parameter: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+    }
+
+    for (std::size_t busters_count : busters_counts)
+    {
+        if (busters_count < 2 || busters_count > 5)
+        {
+            std::cerr << "Unsupported number of busters per player: " << busters_count << std::endl;
+            return 1;
+        }
+    }
+
+    for (std::size_t ghosts_count : ghosts_counts)
+    {
+        if (ghosts_count == 0 || ghosts_count > MAX_GHOSTS_COUNT)
+        {
+            std::cerr << "Unsupported number of ghosts: " << ghosts_count << std::endl;
+            return 1;
+        }
+    }
+
+    const sprt_t sprt(elo0, elo1, alpha, beta);
+    const std::size_t pairs_count = (max_games + 1) / 2;
+
+    std::vector<config_t> configs(busters_counts.size() * ghosts_counts.size());
+    for (std::size_t b = 0; b < busters_counts.size(); ++b)
+    {
+        for (std::size_t g = 0; g < ghosts_counts.size(); ++g)
+        {
+            config_t& config = configs[b * ghosts_counts.size() + g];
+            config.busters_count = busters_counts[b];
+            config.ghosts_count = ghosts_counts[g];
+            config.wins = 0;
+            config.draws = 0;
+            config.losses = 0;
+            config.points_difference = 0;
+            config.decision = sprt_t::decision_t::UNDECIDED;
+            config.games.assign(2 * pairs_count, game_record_t());
+        }
+    }
+
+    // Configs are interleaved, so that all of them progress (and get decided) together
+    work_stealing_pool_t pool(threads_count);
+    for (std::size_t pair = 0; pair < pairs_count; ++pair)
+    {
+        for (config_t& config : configs)
+        {
+            unsigned int seed = random_seed + static_cast<unsigned int>(pair);
+            pool.submit([&config, pair, seed, &sprt, &candidate, &baseline]() { play_pair(config, pair, seed, sprt, candidate, baseline); });
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pool.run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::size_t total_games = 0;
+    std::cout << std::setw(8) << "busters" << std::setw(8) << "ghosts" << std::setw(8) << "games"
+        << std::setw(8) << "wins" << std::setw(8) << "draws" << std::setw(8) << "losses"
+        << std::setw(10) << "score" << std::setw(12) << "points/game" << std::setw(10) << "llr" << "  decision" << std::endl;
+
+    for (const config_t& config : configs)
+    {
+        std::size_t wins = config.wins, draws = config.draws, losses = config.losses;
+        std::size_t games = wins + draws + losses;
+        total_games += games;
+
+        std::cout << std::setw(8) << config.busters_count << std::setw(8) << config.ghosts_count << std::setw(8) << games
+            << std::setw(8) << wins << std::setw(8) << draws << std::setw(8) << losses
+            << std::fixed << std::setprecision(3)
+            << std::setw(10) << ((games > 0) ? (wins + 0.5 * draws) / games : 0.0)
+            << std::setw(12) << ((games > 0) ? static_cast<double>(config.points_difference) / games : 0.0)
+            << std::setw(10) << sprt.get_llr(wins, draws, losses)
+            << "  " << get_decision_name(config.decision) << std::endl;
+
+        report_outliers(config, outliers_count);
+    }
+
+    std::cout << "llr bounds [" << sprt.get_lower_bound() << ", " << sprt.get_upper_bound() << "], "
+        << total_games << " games on " << pool.get_workers_count() << " threads in " << elapsed.count() << " s" << std::endl;
+
+    if (log_path)
+    {
+        std::ofstream log(log_path);
+        log << "busters ghosts seed candidate_team candidate_points baseline_points rounds\n";
+
+        for (const config_t& config : configs)
+        {
+            for (const game_record_t& record : config.games)
+            {
+                if (record.played)
+                {
+                    log << config.busters_count << ' ' << config.ghosts_count << ' ' << record.seed << ' ' << record.candidate_team << ' '
+                        << record.candidate_points << ' ' << record.baseline_points << ' ' << record.rounds << '\n';
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <limits>
 #include <map>
 #include <set>
 #include <vector>
@@ -8,21 +11,36 @@
 #include "types.hpp"
 
 
+static const round_num_t NEVER_ROUND = std::numeric_limits<round_num_t>::max(); // marks events which didn't happen yet
+
+
+template <count_t BUSTERS_COUNT>
 struct tracking_data_t
 {
+    tracking_data_t()
+        : lose_ghost_count(0)
+    {
+        buster_stun_usage.fill(NEVER_ROUND);
+        enemy_stun_usage.fill(NEVER_ROUND);
+        buster_stunned_since.fill(NEVER_ROUND);
+        enemy_stunned_since.fill(NEVER_ROUND);
+    }
+
     std::set<id_type> ghosts_spotted; // set of spotted ghosts
     std::map<id_type, ghost_t> ghosts_out_of_scope; // ghosts which disappeared by leaving visible scope
     std::vector<position_t> ghosts_projected; // projected ghosts via map's symmetry
 
-    std::map<id_type, round_num_t> buster_stun_usage; // `buster_stun_usage[id] == k` means buster #id used STUN last in round #k
-    std::map<id_type, round_num_t> enemy_stun_usage;  // -||-
+    // All per-buster data below is indexed by buster's id (ids of both teams are in [0, 2 * BUSTERS_COUNT))
+
+    std::array<round_num_t, 2 * BUSTERS_COUNT> buster_stun_usage; // `buster_stun_usage[id] == k` means buster #id used STUN last in round #k
+    std::array<round_num_t, 2 * BUSTERS_COUNT> enemy_stun_usage;  // -||-
 
-    std::map<id_type, round_num_t> buster_stunned_since; // `buster_stunned_since[id] == k` means buster #id was last stunned in round #k
-    std::map<id_type, round_num_t> enemy_stunned_since;  // -||-
+    std::array<round_num_t, 2 * BUSTERS_COUNT> buster_stunned_since; // `buster_stunned_since[id] == k` means buster #id was last stunned in round #k
+    std::array<round_num_t, 2 * BUSTERS_COUNT> enemy_stunned_since;  // -||-
 
     std::map<id_type, std::vector<id_type>> busters_busting_ghost; // `busters_busting_ghost[id]` is a list of buster ids who were busting ghost #id
 
     count_t lose_ghost_count; // how many times enemy intercepted our ghost
 
-    std::set<id_type> radar_usage; // track which busters used radar already
+    std::bitset<2 * BUSTERS_COUNT> radar_usage; // track which busters used radar already
 };
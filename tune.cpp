@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "codebusters_referee.hpp"
+#include "command_line.hpp"
+#include "strategy_params.hpp"
+#include "work_stealing_pool.hpp"
+
+
+// Usage: tune [--tune NAME,NAME,...] [--iterations N] [--games N] [--busters 2,3,4,5] [--ghosts 8,15,28]
+//             [--seed N] [--threads N] [--learning-rate X] [--perturbation X] [--params FILE] [--output FILE]
+//
+// Tunes strategy parameters (all of them unless `--tune` lists some) with SPSA, starting from defaults or from
+// `--params` file. Every iteration perturbs all tuned parameters at once in random directions (+/- `--perturbation`
+// of parameter's starting value) and plays both perturbed sets against each other for `--games` games spread over
+// all cores, every seed twice with sides swapped and configs (number of busters and ghosts) taken in turns.
+// Mean points difference per game is the gradient estimate all parameters are moved along.
+//
+// Current parameters are written to `--output` FILE (loadable with `--params` of other tools) after every
+// iteration, so that tuning can be stopped at any time, and to stdout at the end.
+
+namespace
+{
+    struct config_t
+    {
+        count_t busters_count;
+        count_t ghosts_count;
+    };
+
+    struct tuned_param_t
+    {
+        const strategy_params_t::param_t* param;
+        factor_t step; // perturbation at first iteration
+    };
+
+    std::vector<std::string> parse_names(const char* text)
+    {
+        std::vector<std::string> result;
+
+        for (const char* current = text; *current != '\0';)
+        {
+            const char* end = std::strchr(current, ',');
+            if (!end)
+                end = current + std::strlen(current);
+
+            result.emplace_back(current, end);
+            current = (*end == ',') ? end + 1 : end;
+        }
+
+        return result;
+    }
+
+    // Points of `plus` minus points of `minus`, summed over both sides of given seed
+    long long int play_pair(const config_t& config, unsigned int seed, const strategy_params_t& plus, const strategy_params_t& minus)
+    {
+        match_result_t first = play_codebusters_match(config.busters_count, config.ghosts_count, seed, plus, minus);
+        match_result_t second = play_codebusters_match(config.busters_count, config.ghosts_count, seed, minus, plus);
+
+        return static_cast<long long int>(first.points[0]) - static_cast<long long int>(first.points[1]) +
+            static_cast<long long int>(second.points[1]) - static_cast<long long int>(second.points[0]);
+    }
+
+    bool save(const char* path, const strategy_params_t& params)
+    {
+        std::ofstream file(path);
+        params.save(file);
+        return static_cast<bool>(file);
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> tuned_names;
+    std::size_t iterations = 100;
+    std::size_t games = 200;
+    std::vector<std::size_t> busters_counts { 2, 3, 4, 5 };
+    std::vector<std::size_t> ghosts_counts { 8, 15, 28 };
+    unsigned int random_seed = DEFAULT_RANDOM_SEED;
+    std::size_t threads_count = std::max(1u, std::thread::hardware_concurrency());
+    double learning_rate = 1.0;
+    double perturbation = 0.1;
+    strategy_params_t params;
+    const char* output_path = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--tune") == 0)
+            tuned_names = parse_names(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--games") == 0)
+            games = std::strtoul(argv[i + 1], nullptr, 10);
+        else if ((std::strcmp(argv[i], "--busters") == 0 && !parse_list(argv[i + 1], busters_counts)) ||
+            (std::strcmp(argv[i], "--ghosts") == 0 && !parse_list(argv[i + 1], ghosts_counts)))
+        {
+            std::cerr << "Invalid list of numbers: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            random_seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            threads_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--learning-rate") == 0)
+            learning_rate = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--perturbation") == 0)
+            perturbation = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--output") == 0)
+            output_path = argv[i + 1];
+        else if (std::strcmp(argv[i], "--params") == 0 && !params.load(argv[i + 1]))
+        {
+            std::cerr << "Can't load strategy parameters: " << argv[i + 1] << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<config_t> configs;
+    for (std::size_t busters_count : busters_counts)
+    {
+        if (busters_count < 2 || busters_count > 5)
+        {
+            std::cerr << "Unsupported number of busters per player: " << busters_count << std::endl;
+            return 1;
+        }
+
+        for (std::size_t ghosts_count : ghosts_counts)
+        {
+            if (ghosts_count == 0 || ghosts_count > MAX_GHOSTS_COUNT)
+            {
+                std::cerr << "Unsupported number of ghosts: " << ghosts_count << std::endl;
+                return 1;
+            }
+
+            configs.push_back(config_t { busters_count, ghosts_count });
+        }
+    }
+
+    for (const std::string& name : tuned_names)
+    {
+        strategy_params_t check;
+        if (!check.set(name, 0.0))
+        {
+            std::cerr << "Unknown strategy parameter: " << name << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<tuned_param_t> tuned;
+    for (const strategy_params_t::param_t& param : strategy_params_t::get_params())
+    {
+        if (tuned_names.empty() || std::find(tuned_names.begin(), tuned_names.end(), param.name) != tuned_names.end())
+            tuned.push_back(tuned_param_t { &param, std::max(1e-3, perturbation * std::abs(params.*param.member)) });
+    }
+
+    // Standard SPSA gain sequences, stability constant of 10 % of iterations
+    const double stability = iterations / 10.0;
+    const std::size_t pairs_count = std::max<std::size_t>(1, games / 2);
+    std::mt19937 random_engine(random_seed);
+
+    for (std::size_t k = 0; k < iterations; ++k)
+    {
+        const double gain = learning_rate / std::pow(stability + k + 1.0, 0.602);
+        const double spread = 1.0 / std::pow(k + 1.0, 0.101);
+
+        strategy_params_t plus = params;
+        strategy_params_t minus = params;
+        std::vector<int> directions(tuned.size());
+
+        for (std::size_t i = 0; i < tuned.size(); ++i)
+        {
+            directions[i] = (random_engine() & 1) ? 1 : -1;
+
+            factor_t strategy_params_t::* member = tuned[i].param->member;
+            factor_t shift = spread * tuned[i].step * directions[i];
+            plus.*member = std::max(0.0, params.*member + shift);
+            minus.*member = std::max(0.0, params.*member - shift);
+        }
+
+        // Every pair writes own slot, so that the sum doesn't depend on number of threads
+        std::vector<long long int> differences(pairs_count, 0);
+        work_stealing_pool_t pool(threads_count);
+
+        for (std::size_t pair = 0; pair < pairs_count; ++pair)
+        {
+            std::size_t game_index = k * pairs_count + pair;
+            const config_t& config = configs[game_index % configs.size()];
+            unsigned int seed = random_seed + static_cast<unsigned int>(game_index);
+
+            pool.submit([&differences, pair, &config, seed, &plus, &minus]() { differences[pair] = play_pair(config, seed, plus, minus); });
+        }
+
+        pool.run();
+
+        long long int difference = 0;
+        for (long long int pair_difference : differences)
+            difference += pair_difference;
+
+        const double mean_difference = static_cast<double>(difference) / (2.0 * pairs_count);
+
+        // Gradient estimate along every direction is `mean_difference / (2 * spread * direction)`, in units of step
+        for (std::size_t i = 0; i < tuned.size(); ++i)
+        {
+            factor_t strategy_params_t::* member = tuned[i].param->member;
+            params.*member = std::max(0.0, params.*member + gain * tuned[i].step * mean_difference * directions[i] / (2.0 * spread));
+        }
+
+        std::cerr << "iteration " << k + 1 << "/" << iterations << ": plus - minus " << std::fixed << std::setprecision(3)
+            << mean_difference << " points/game" << std::endl;
+
+        if (output_path && !save(output_path, params))
+        {
+            std::cerr << "Can't write strategy parameters: " << output_path << std::endl;
+            return 1;
+        }
+    }
+
+    params.save(std::cout);
+
+    return 0;
+}
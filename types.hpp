@@ -16,12 +16,12 @@ using factor_t = double;
 class position_t
 {
 public:
-    position_t()
+    constexpr position_t()
         : position_t(0, 0)
     {
     }
 
-    position_t(coord_t x_, coord_t y_)
+    constexpr position_t(coord_t x_, coord_t y_)
         : x(x_), y(y_)
     {
     }
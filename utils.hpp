@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 #include "entity.hpp"
+#include "moves_table.hpp"
 #include "types.hpp"
 
 
@@ -29,8 +31,42 @@ double distance_between(const buster_t& b1, const buster_t& b2)
     return distance_between(b1.position, b2.position);
 }
 
+// Squared distances and range predicates, without `sqrt`. Squared distance is exact integer, square of range is
+// computed as double (ranges may be fractional, e.g. tuned ones), so that comparison is exact below 2^53.
+
+std::int64_t squared_distance_between(const position_t& p1, const position_t& p2)
+{
+    std::int64_t dx = static_cast<std::int64_t>(p1.x) - static_cast<std::int64_t>(p2.x);
+    std::int64_t dy = static_cast<std::int64_t>(p1.y) - static_cast<std::int64_t>(p2.y);
+
+    return dx*dx + dy*dy;
+}
+
+double squared_range(double range)
+{
+    return range * range;
+}
+
+// distance(p1, p2) <= range
+bool is_within_range(const position_t& p1, const position_t& p2, double range)
+{
+    return (static_cast<double>(squared_distance_between(p1, p2)) <= squared_range(range));
+}
+
+// distance(p1, p2) < range
+bool is_closer_than(const position_t& p1, const position_t& p2, double range)
+{
+    return (static_cast<double>(squared_distance_between(p1, p2)) < squared_range(range));
+}
+
 count_t moves_from_distance(double distance)
 {
     const double MOVE_DISTANCE = 800.0;
     return static_cast<count_t>(std::ceil(distance / MOVE_DISTANCE));
 }
+
+// Same as `moves_from_distance(sqrt(squared_distance))`, but from lookup table and without floating point
+count_t moves_from_squared_distance(std::int64_t squared_distance)
+{
+    return moves_table_t<800, 0>::moves(squared_distance);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+// Runs given action on background thread when armed deadline passes before being disarmed.
+//
+// Action runs under watchdog's lock, so `disarm` waits for it to finish and tells whether it ran, i.e. exactly
+// one of action and caller's own (regular) path gets executed for every arming. Caller can also poll whether
+// action ran (and when it finished) to give up the rest of its path early. Background thread is started
+// on first arming, so watchdog which is never armed costs nothing.
+
+class watchdog_t
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+
+public:
+    explicit watchdog_t(std::function<void()> action)
+        : action(action), deadline(), fired_at(), armed(false), fired(false), stopping(false)
+    {
+    }
+
+    ~watchdog_t()
+    {
+        if (!thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        condition.notify_one();
+        thread.join();
+    }
+
+    watchdog_t(const watchdog_t&) = delete;
+    watchdog_t& operator=(const watchdog_t&) = delete;
+
+    void arm(clock_t::time_point expiration)
+    {
+        if (!thread.joinable())
+            thread = std::thread(&watchdog_t::run, this);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            deadline = expiration;
+            armed = true;
+            fired = false;
+        }
+
+        condition.notify_one();
+    }
+
+    // Whether action already ran since last arming
+    bool has_fired()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return fired;
+    }
+
+    // When action finished, valid only if `has_fired()`
+    clock_t::time_point get_fired_at()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return fired_at;
+    }
+
+    // Returns `false` if action already ran since last arming
+    bool disarm()
+    {
+        bool result;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            result = !fired;
+            armed = false;
+        }
+
+        condition.notify_one();
+        return result;
+    }
+
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (!stopping)
+        {
+            if (!armed)
+            {
+                condition.wait(lock);
+            }
+            else if (clock_t::now() < deadline)
+            {
+                condition.wait_until(lock, deadline);
+            }
+            else
+            {
+                armed = false;
+                fired = true;
+                action();
+                fired_at = clock_t::now();
+            }
+        }
+    }
+
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::function<void()> action;
+    clock_t::time_point deadline;
+    clock_t::time_point fired_at; // when action last finished
+    bool armed;
+    bool fired;
+    bool stopping;
+    std::thread thread; // started by first `arm`, after all state it uses is initialized
+};
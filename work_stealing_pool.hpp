@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads running batch of independent jobs.
+//
+// Jobs are dealt round-robin to per-worker queues up front. Every worker takes jobs from the front of its own
+// queue (so jobs run roughly in submission order) and, once it runs dry, steals from the back of other workers'
+// queues, so that workers which got shorter jobs (e.g. games which ended early) help the others instead of idling.
+// `run` returns when all jobs are done.
+
+class work_stealing_pool_t
+{
+public:
+    using job_t = std::function<void()>;
+
+
+private:
+    struct queue_t
+    {
+        std::mutex mutex;
+        std::deque<job_t> jobs;
+    };
+
+
+public:
+    explicit work_stealing_pool_t(std::size_t workers_count)
+        : next_queue(0)
+    {
+        if (workers_count == 0)
+            workers_count = 1;
+
+        for (std::size_t i = 0; i < workers_count; ++i)
+            queues.emplace_back(new queue_t());
+    }
+
+    work_stealing_pool_t(const work_stealing_pool_t&) = delete;
+    work_stealing_pool_t& operator=(const work_stealing_pool_t&) = delete;
+
+    // Has to be called before `run`
+    void submit(job_t job)
+    {
+        queues[next_queue]->jobs.push_back(std::move(job));
+        next_queue = (next_queue + 1) % queues.size();
+    }
+
+    // Runs all submitted jobs, calling thread is one of the workers
+    void run()
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t worker = 1; worker < queues.size(); ++worker)
+            threads.emplace_back(&work_stealing_pool_t::work, this, worker);
+
+        work(0);
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    std::size_t get_workers_count() const
+    {
+        return queues.size();
+    }
+
+
+private:
+    void work(std::size_t worker)
+    {
+        job_t job;
+        while (pop_own(worker, job) || steal(worker, job))
+            job();
+    }
+
+    bool pop_own(std::size_t worker, job_t& job)
+    {
+        queue_t& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.jobs.empty())
+            return false;
+
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    // No jobs are submitted while running, so worker which finds all queues empty is done
+    bool steal(std::size_t worker, job_t& job)
+    {
+        for (std::size_t i = 1; i < queues.size(); ++i)
+        {
+            queue_t& queue = *queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.jobs.empty())
+                continue;
+
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            return true;
+        }
+
+        return false;
+    }
+
+
+private:
+    std::vector<std::unique_ptr<queue_t>> queues; // by worker
+    std::size_t next_queue; // for dealing submitted jobs
+};